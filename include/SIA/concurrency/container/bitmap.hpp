@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/thread_index.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace bitmap_detail
+        {
+            using word_type = std::uint64_t;
+
+            constexpr size_t word_bit() noexcept { return sizeof(word_type) * 8; }
+            constexpr word_type full_word() noexcept { return ~word_type{ }; }
+            constexpr size_t word_num(size_t bit) noexcept { return (bit + word_bit() - 1) / word_bit(); }
+
+            // bits beyond size are kept set, so they are never free.
+            constexpr word_type tail_mask(size_t bit) noexcept
+            { return bit % word_bit() == 0 ? word_type{ } : full_word() << (bit % word_bit()); }
+        } // namespace bitmap_detail
+
+        // lock-free slot / id allocator over [0, Size).
+        // set bit = used. summary bit i = word i is full (a hint, repaired by the thread that race with it).
+        // acquire skip full words through the summary, find the first free bit with std::countr_one and claim it with one CAS.
+        // each thread start from its own hint word (per_thread), so threads do not pile up on the first word.
+        template <size_t Size, size_t HintNum = 64>
+            requires (Size > 0)
+        struct bitmap
+        {
+            private:
+                using word_type = bitmap_detail::word_type;
+
+                static constexpr size_t word_num() noexcept { return bitmap_detail::word_num(Size); }
+                static constexpr size_t summary_num() noexcept { return bitmap_detail::word_num(word_num()); }
+
+                std::atomic<word_type> m_word[word_num()];
+                std::atomic<word_type> m_summary[summary_num()];
+                per_thread<size_t, HintNum> m_hint;
+
+                // threads beyond HintNum start from a spread word and keep no cursor.
+                constexpr size_t* hint(size_t& fallback) noexcept
+                {
+                    const size_t idx = thread_index();
+                    if (idx < HintNum)
+                    { return &m_hint[idx]; }
+                    fallback = (idx * 0x9e3779b97f4a7c15ULL) % word_num();
+                    return &fallback;
+                }
+
+                constexpr void mark_full(size_t word) noexcept
+                {
+                    std::atomic<word_type>& target = m_summary[word / bitmap_detail::word_bit()];
+                    const word_type bit = word_type{1} << (word % bitmap_detail::word_bit());
+                    target.fetch_or(bit, std::memory_order::seq_cst);
+                    // a release may have slipped in before the summary bit was set.
+                    if (m_word[word].load(std::memory_order::seq_cst) != bitmap_detail::full_word())
+                    { target.fetch_and(~bit, std::memory_order::seq_cst); }
+                }
+
+                constexpr bool try_claim(size_t word, size_t& out) noexcept
+                {
+                    std::atomic<word_type>& target = m_word[word];
+                    word_type tmp = target.load(std::memory_order::relaxed);
+                    while (tmp != bitmap_detail::full_word())
+                    {
+                        const size_t pos = static_cast<size_t>(std::countr_one(tmp));
+                        const word_type next = tmp | (word_type{1} << pos);
+                        if (target.compare_exchange_weak(tmp, next, std::memory_order::acq_rel, std::memory_order::relaxed))
+                        {
+                            if (next == bitmap_detail::full_word())
+                            { mark_full(word); }
+                            out = word * bitmap_detail::word_bit() + pos;
+                            return true;
+                        }
+                    }
+                    mark_full(word);
+                    return false;
+                }
+
+            public:
+                bitmap()
+                    : m_word(), m_summary(), m_hint()
+                {
+                    for (auto& elem : m_word)
+                    { elem.store(word_type{ }, std::memory_order::relaxed); }
+                    m_word[word_num() - 1].store(bitmap_detail::tail_mask(Size), std::memory_order::relaxed);
+                    for (auto& elem : m_summary)
+                    { elem.store(word_type{ }, std::memory_order::relaxed); }
+                    m_summary[summary_num() - 1].store(bitmap_detail::tail_mask(word_num()), std::memory_order::relaxed);
+                    for (size_t idx { }; idx < HintNum; ++idx)
+                    { m_hint[idx] = (idx * word_num()) / HintNum; }
+                }
+
+                bitmap(const bitmap&) = delete;
+                bitmap(bitmap&&) = delete;
+                bitmap& operator=(const bitmap&) = delete;
+                bitmap& operator=(bitmap&&) = delete;
+
+                static constexpr size_t capacity() noexcept { return Size; }
+
+                // claim a free slot. false when every slot is used.
+                constexpr bool try_acquire(size_t& out) noexcept
+                {
+                    size_t fallback { };
+                    size_t* start = hint(fallback);
+                    const size_t first = *start % word_num();
+                    const size_t first_summary = first / bitmap_detail::word_bit();
+                    for (size_t step { }; step <= summary_num(); ++step)
+                    {
+                        const size_t sidx = (first_summary + step) % summary_num();
+                        word_type free = ~m_summary[sidx].load(std::memory_order::acquire);
+                        // the start summary word is visited twice : upper bits first, lower bits last.
+                        if (step == 0) { free &= bitmap_detail::full_word() << (first % bitmap_detail::word_bit()); }
+                        else if (step == summary_num()) { free &= ~(bitmap_detail::full_word() << (first % bitmap_detail::word_bit())); }
+                        while (free != 0)
+                        {
+                            const size_t bit = static_cast<size_t>(std::countr_zero(free));
+                            free &= free - 1;
+                            const size_t word = sidx * bitmap_detail::word_bit() + bit;
+                            if (try_claim(word, out))
+                            {
+                                *start = word;
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+                constexpr void release(size_t idx) noexcept
+                {
+                    assertm(idx < Size, "Error : bitmap index out of range");
+                    const size_t word = idx / bitmap_detail::word_bit();
+                    const word_type bit = word_type{1} << (idx % bitmap_detail::word_bit());
+                    const word_type prev = m_word[word].fetch_and(~bit, std::memory_order::seq_cst);
+                    assertm((prev & bit) != 0, "Error : bitmap double release");
+                    if (prev == bitmap_detail::full_word())
+                    { m_summary[word / bitmap_detail::word_bit()].fetch_and(~(word_type{1} << (word % bitmap_detail::word_bit())), std::memory_order::seq_cst); }
+                }
+
+                constexpr bool test(size_t idx, std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return (m_word[idx / bitmap_detail::word_bit()].load(mem_order) >> (idx % bitmap_detail::word_bit()) & 1) != 0; }
+
+                // used slot count. exact only when quiescent.
+                constexpr size_t count(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                {
+                    size_t ret { };
+                    for (auto& elem : m_word)
+                    { ret += static_cast<size_t>(std::popcount(elem.load(mem_order))); }
+                    return ret - static_cast<size_t>(std::popcount(bitmap_detail::tail_mask(Size)));
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
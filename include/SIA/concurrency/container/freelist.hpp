@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/container/stack.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace freelist_detail
+        {
+            // raw storage of one object. a free slot hold a stack_hook in place of T.
+            template <typename T>
+            struct slot
+            {
+                alignas(std::max(alignof(T), alignof(stack_hook))) byte_t m_storage[std::max(sizeof(T), sizeof(stack_hook))];
+            };
+
+            template <size_t MagazineSize>
+            struct magazine : public stack_hook
+            {
+                size_t m_count;
+                void* m_item[MagazineSize];
+
+                constexpr bool is_full() const noexcept { return m_count == MagazineSize; }
+                constexpr bool is_empty() const noexcept { return m_count == 0; }
+            };
+
+            template <size_t MagazineSize>
+            struct cache
+            {
+                magazine<MagazineSize>* m_loaded;
+                magazine<MagazineSize>* m_previous;
+            };
+        } // namespace freelist_detail
+
+        // fixed-size object freelist. Size slots are allocated once and recycled forever.
+        // each thread keep two magazines (loaded / previous) of free slots, so most allocate / deallocate
+        // touch no shared state. full and empty magazines are exchanged through lock-free depots,
+        // and the shared slot stack is the last resort.
+        // slots cached by other threads are not visible to allocate, so Size should exceed 2 * MagazineSize * threads
+        // when the list is expected to run dry.
+        template <typename T, size_t Size, size_t MagazineSize = 32, typename Allocator = std::allocator<T>>
+            requires ((Size > 0) && (MagazineSize > 0))
+        struct freelist
+        {
+            private:
+                using slot_type = freelist_detail::slot<T>;
+                using magazine_type = freelist_detail::magazine<MagazineSize>;
+                using cache_type = freelist_detail::cache<MagazineSize>;
+                using allocator_type = std::allocator_traits<Allocator>::template rebind_alloc<slot_type>;
+                using allocator_traits_t = std::allocator_traits<allocator_type>;
+                using magazine_allocator_type = std::allocator_traits<Allocator>::template rebind_alloc<magazine_type>;
+                using magazine_traits_t = std::allocator_traits<magazine_allocator_type>;
+
+                compressed_pair<allocator_type, slot_type*> m_compair;
+                intrusive_stack<stack_hook> m_slots;
+                intrusive_stack<magazine_type> m_full;
+                intrusive_stack<magazine_type> m_empty;
+                thread_record_list<cache_type> m_caches;
+
+                constexpr allocator_type& get_allocator() noexcept { return m_compair.first(); }
+                constexpr slot_type*& get_storage() noexcept { return m_compair.second(); }
+
+                // magazines come from the same allocator as the slots (rebound).
+                constexpr magazine_type* make_magazine()
+                {
+                    magazine_type* ret = m_empty.pop();
+                    if (ret == nullptr)
+                    {
+                        magazine_allocator_type alloc {get_allocator()};
+                        ret = std::construct_at(magazine_traits_t::allocate(alloc, 1));
+                    }
+                    return ret;
+                }
+
+                constexpr void free_magazine(magazine_type* at) noexcept
+                {
+                    if (at == nullptr)
+                    { return; }
+                    magazine_allocator_type alloc {get_allocator()};
+                    std::destroy_at(at);
+                    magazine_traits_t::deallocate(alloc, at, 1);
+                }
+
+                constexpr void free_chain(magazine_type* at) noexcept
+                {
+                    while (at != nullptr)
+                    {
+                        magazine_type* next = intrusive_stack<magazine_type>::next_of(at);
+                        free_magazine(at);
+                        at = next;
+                    }
+                }
+
+            public:
+                constexpr freelist(const Allocator& alloc = Allocator{ })
+                    : m_compair(splits::one_v, alloc, nullptr), m_slots(), m_full(), m_empty(), m_caches()
+                {
+                    get_storage() = allocator_traits_t::allocate(get_allocator(), Size);
+                    for (size_t i = Size; i-- > 0;)
+                    { m_slots.push(std::construct_at(reinterpret_cast<stack_hook*>(get_storage()[i].m_storage))); }
+                }
+
+                freelist(const freelist&) = delete;
+                freelist(freelist&&) = delete;
+                freelist& operator=(const freelist&) = delete;
+                freelist& operator=(freelist&&) = delete;
+
+                // objects still out are not destroyed.
+                ~freelist() noexcept
+                {
+                    m_caches.for_each(
+                        [this] (cache_type& elem) noexcept
+                        {
+                            free_magazine(elem.m_loaded);
+                            free_magazine(elem.m_previous);
+                        });
+                    free_chain(m_full.pop_all());
+                    free_chain(m_empty.pop_all());
+                    allocator_traits_t::deallocate(get_allocator(), get_storage(), Size);
+                }
+
+                static constexpr size_t capacity() noexcept { return Size; }
+
+                constexpr bool is_own(const T* ptr) noexcept
+                {
+                    const void* target = ptr;
+                    return target >= get_storage() && target < get_storage() + Size;
+                }
+
+                // uninitialized storage for one T, nullptr when no slot is reachable.
+                constexpr T* allocate()
+                {
+                    cache_type& local = m_caches.local();
+                    if (local.m_loaded == nullptr)
+                    {
+                        local.m_loaded = make_magazine();
+                        local.m_previous = make_magazine();
+                    }
+                    if (local.m_loaded->is_empty())
+                    {
+                        if (!local.m_previous->is_empty())
+                        { std::swap(local.m_loaded, local.m_previous); }
+                        else if (magazine_type* full = m_full.pop(); full != nullptr)
+                        {
+                            m_empty.push(local.m_previous);
+                            local.m_previous = local.m_loaded;
+                            local.m_loaded = full;
+                        }
+                        else
+                        { return reinterpret_cast<T*>(m_slots.pop()); }
+                    }
+                    return static_cast<T*>(local.m_loaded->m_item[--local.m_loaded->m_count]);
+                }
+
+                constexpr void deallocate(T* ptr)
+                {
+                    assertm(is_own(ptr), "Error : pointer is not from this freelist");
+                    cache_type& local = m_caches.local();
+                    if (local.m_loaded == nullptr)
+                    {
+                        local.m_loaded = make_magazine();
+                        local.m_previous = make_magazine();
+                    }
+                    if (local.m_loaded->is_full())
+                    {
+                        if (!local.m_previous->is_full())
+                        { std::swap(local.m_loaded, local.m_previous); }
+                        else
+                        {
+                            m_full.push(local.m_previous);
+                            local.m_previous = local.m_loaded;
+                            local.m_loaded = make_magazine();
+                        }
+                    }
+                    local.m_loaded->m_item[local.m_loaded->m_count++] = ptr;
+                }
+
+                template <typename... Tys>
+                constexpr T* construct(Tys&&... args)
+                {
+                    T* ret = allocate();
+                    if (ret == nullptr)
+                    { return nullptr; }
+                    if constexpr (std::is_nothrow_constructible_v<T, Tys...>)
+                    { return std::construct_at(ret, std::forward<Tys>(args)...); }
+                    else
+                    {
+                        try { return std::construct_at(ret, std::forward<Tys>(args)...); }
+                        catch (...) { deallocate(ret); throw; }
+                    }
+                }
+
+                constexpr void destroy(T* ptr)
+                {
+                    std::destroy_at(ptr);
+                    deallocate(ptr);
+                }
+
+                // give this thread's magazines back to the depots (call before thread exit on thread churn).
+                constexpr void detach()
+                {
+                    cache_type& local = m_caches.local();
+                    for (magazine_type* elem : {local.m_loaded, local.m_previous})
+                    {
+                        if (elem == nullptr) { continue; }
+                        if (elem->is_empty()) { m_empty.push(elem); }
+                        else { m_full.push(elem); }
+                    }
+                    local = cache_type{ };
+                    m_caches.release();
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+#include "SIA/concurrency/utility/epoch.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace hash_map_detail
+        {
+            // control byte : empty / tombstone / (full_bit | 7 bit tag)
+            constexpr std::uint8_t empty_ctrl() noexcept { return 0; }
+            constexpr std::uint8_t tombstone_ctrl() noexcept { return 1; }
+            constexpr std::uint8_t full_bit() noexcept { return 0x80; }
+            constexpr bool is_free(std::uint8_t ctrl) noexcept { return (ctrl & full_bit()) == 0; }
+
+            // std::hash of integers is identity on major implementations. spread it for power-of-two probing.
+            constexpr size_t mix(size_t arg) noexcept
+            {
+                std::uint64_t ret = arg;
+                ret ^= ret >> 33;
+                ret *= 0xff51afd7ed558ccdULL;
+                ret ^= ret >> 33;
+                ret *= 0xc4ceb9fe1a85ec53ULL;
+                ret ^= ret >> 33;
+                return static_cast<size_t>(ret);
+            }
+
+            constexpr std::uint8_t tag_of(size_t hash) noexcept
+            { return static_cast<std::uint8_t>(full_bit() | (hash >> (sizeof(size_t) * 8 - 7))); }
+
+            template <typename K, typename V>
+            consteval size_t group_slot_num() noexcept
+            {
+                constexpr size_t ret = (std::hardware_destructive_interference_size - sizeof(std::uint32_t)) / (1 + sizeof(K) + sizeof(V));
+                return ret == 0 ? 1 : ret;
+            }
+
+            // one cache line of slots guarded by a seqlock version (odd while written).
+            template <typename K, typename V, size_t SlotNum = group_slot_num<K, V>()>
+            struct alignas(std::hardware_destructive_interference_size) group
+            {
+                std::atomic<std::uint32_t> m_version;
+                std::atomic<std::uint8_t> m_ctrl[SlotNum];
+                std::atomic<K> m_key[SlotNum];
+                std::atomic<V> m_value[SlotNum];
+
+                static constexpr size_t slot_size() noexcept { return SlotNum; }
+
+                constexpr group() noexcept
+                    : m_version(0)
+                {
+                    for (auto& elem : m_ctrl)
+                    { elem.store(empty_ctrl(), std::memory_order::relaxed); }
+                }
+
+                constexpr void lock() noexcept
+                {
+                    std::uint32_t tmp = m_version.load(std::memory_order::relaxed);
+                    while ((tmp & 1) != 0 || !m_version.compare_exchange_weak(tmp, tmp + 1, std::memory_order::acquire, std::memory_order::relaxed))
+                    { tmp = m_version.load(std::memory_order::relaxed); }
+                    std::atomic_thread_fence(std::memory_order::release);
+                }
+
+                constexpr void unlock() noexcept
+                { m_version.store(m_version.load(std::memory_order::relaxed) + 1, std::memory_order::release); }
+
+                // run func over a consistent view of the group. retried until no writer interleaved.
+                template <typename Func>
+                constexpr bool read(Func&& func) const noexcept
+                {
+                    while (true)
+                    {
+                        const std::uint32_t begin = m_version.load(std::memory_order::acquire);
+                        if ((begin & 1) != 0)
+                        { continue; }
+                        bool ret = func();
+                        std::atomic_thread_fence(std::memory_order::acquire);
+                        if (m_version.load(std::memory_order::relaxed) == begin)
+                        { return ret; }
+                    }
+                }
+            };
+
+            template <typename K, typename V>
+            struct table
+            {
+                using group_type = group<K, V>;
+
+                const size_t m_group_num;
+                std::unique_ptr<group_type[]> m_group;
+                true_share<std::atomic<size_t>> m_used;
+                true_share<std::atomic<size_t>> m_cursor;
+                std::atomic<size_t> m_done;
+                std::atomic<table*> m_next;
+
+                table(size_t group_num)
+                    : m_group_num(group_num), m_group(new group_type[group_num]), m_used(0), m_cursor(0), m_done(0), m_next(nullptr)
+                { }
+
+                constexpr size_t capacity() const noexcept { return m_group_num * group_type::slot_size(); }
+                constexpr bool is_crowded() noexcept { return m_used->load(std::memory_order::relaxed) * 4 >= capacity() * 3; }
+            };
+
+            struct position
+            {
+                size_t m_group;
+                size_t m_slot;
+                bool m_found;
+            };
+        } // namespace hash_map_detail
+
+        // concurrent open addressing hash map.
+        // K and V must be lock-free atomics (ids, handles, pointers). store a pointer for larger values.
+        // - readers are lock-free : seqlock validated reads of cache line groups inside an epoch section.
+        // - writers serialize per key on StripeNum striped locks and lock only the group they modify.
+        // - growth is incremental : writers migrate a few groups each until the next table take over,
+        //   and the old table is reclaimed through epoch_domain.
+        template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>, size_t StripeNum = 64>
+            requires (std::atomic<K>::is_always_lock_free && std::atomic<V>::is_always_lock_free && std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V> && (StripeNum > 0))
+        struct hash_map
+        {
+            private:
+                using table_type = hash_map_detail::table<K, V>;
+                using group_type = table_type::group_type;
+                using position = hash_map_detail::position;
+
+                static constexpr size_t migrate_chunk() noexcept { return 4; }
+
+                std::atomic<table_type*> m_table;
+                true_share<std::atomic<size_t>> m_size;
+                true_share<sia::mutex> m_stripe[StripeNum];
+                sia::mutex m_resize;
+                epoch_domain<> m_epoch;
+                compressed_pair<Hash, KeyEqual> m_functor;
+
+                constexpr size_t hash_of(const K& key) const noexcept(std::is_nothrow_invocable_v<const Hash&, const K&>)
+                { return hash_map_detail::mix(m_functor.first()(key)); }
+
+                static constexpr size_t stripe_of(size_t hash) noexcept
+                { return (hash >> (sizeof(size_t) * 4)) % StripeNum; }
+
+                static constexpr size_t round_groups(size_t capacity) noexcept
+                {
+                    size_t ret = 1;
+                    while (ret * group_type::slot_size() < capacity) { ret <<= 1; }
+                    return ret;
+                }
+
+                // lock-free lookup in one table.
+                constexpr bool search(table_type& tbl, const K& key, size_t hash, V& out) const noexcept
+                {
+                    const std::uint8_t tag = hash_map_detail::tag_of(hash);
+                    const size_t mask = tbl.m_group_num - 1;
+                    for (size_t step { }, at = hash & mask; step < tbl.m_group_num; ++step, at = (at + 1) & mask)
+                    {
+                        const group_type& grp = tbl.m_group[at];
+                        bool found { }, has_empty { };
+                        grp.read(
+                            [&] () noexcept
+                            {
+                                found = has_empty = false;
+                                for (size_t pos { }; pos < group_type::slot_size(); ++pos)
+                                {
+                                    const std::uint8_t ctrl = grp.m_ctrl[pos].load(std::memory_order::relaxed);
+                                    if (ctrl == hash_map_detail::empty_ctrl())
+                                    { has_empty = true; }
+                                    else if (ctrl == tag && m_functor.second()(grp.m_key[pos].load(std::memory_order::relaxed), key))
+                                    {
+                                        out = grp.m_value[pos].load(std::memory_order::relaxed);
+                                        found = true;
+                                        return true;
+                                    }
+                                }
+                                return false;
+                            });
+                        if (found) { return true; }
+                        if (has_empty) { return false; }
+                    }
+                    return false;
+                }
+
+                // lookup by the owner of the key's stripe. slots of this key can not change under it.
+                constexpr position locate(table_type& tbl, const K& key, size_t hash) const noexcept
+                {
+                    const std::uint8_t tag = hash_map_detail::tag_of(hash);
+                    const size_t mask = tbl.m_group_num - 1;
+                    for (size_t step { }, at = hash & mask; step < tbl.m_group_num; ++step, at = (at + 1) & mask)
+                    {
+                        group_type& grp = tbl.m_group[at];
+                        bool has_empty { };
+                        for (size_t pos { }; pos < group_type::slot_size(); ++pos)
+                        {
+                            const std::uint8_t ctrl = grp.m_ctrl[pos].load(std::memory_order::acquire);
+                            if (ctrl == hash_map_detail::empty_ctrl())
+                            { has_empty = true; }
+                            else if (ctrl == tag && m_functor.second()(grp.m_key[pos].load(std::memory_order::relaxed), key))
+                            { return position{at, pos, true}; }
+                        }
+                        if (has_empty) { break; }
+                    }
+                    return position{0, 0, false};
+                }
+
+                // insert a key known to be absent. false when the table has no free slot on the probe path.
+                constexpr bool place(table_type& tbl, const K& key, const V& value, size_t hash) noexcept
+                {
+                    const std::uint8_t tag = hash_map_detail::tag_of(hash);
+                    const size_t mask = tbl.m_group_num - 1;
+                    for (size_t step { }, at = hash & mask; step < tbl.m_group_num; ++step, at = (at + 1) & mask)
+                    {
+                        group_type& grp = tbl.m_group[at];
+                        grp.lock();
+                        for (size_t pos { }; pos < group_type::slot_size(); ++pos)
+                        {
+                            const std::uint8_t ctrl = grp.m_ctrl[pos].load(std::memory_order::relaxed);
+                            if (hash_map_detail::is_free(ctrl))
+                            {
+                                grp.m_key[pos].store(key, std::memory_order::relaxed);
+                                grp.m_value[pos].store(value, std::memory_order::relaxed);
+                                grp.m_ctrl[pos].store(tag, std::memory_order::release);
+                                grp.unlock();
+                                if (ctrl == hash_map_detail::empty_ctrl())
+                                { tbl.m_used->fetch_add(1, std::memory_order::relaxed); }
+                                return true;
+                            }
+                        }
+                        grp.unlock();
+                    }
+                    return false;
+                }
+
+                static constexpr void assign(table_type& tbl, position pos, const V& value) noexcept
+                {
+                    group_type& grp = tbl.m_group[pos.m_group];
+                    grp.lock();
+                    grp.m_value[pos.m_slot].store(value, std::memory_order::relaxed);
+                    grp.unlock();
+                }
+
+                static constexpr void bury(table_type& tbl, position pos) noexcept
+                {
+                    group_type& grp = tbl.m_group[pos.m_group];
+                    grp.lock();
+                    grp.m_ctrl[pos.m_slot].store(hash_map_detail::tombstone_ctrl(), std::memory_order::relaxed);
+                    grp.unlock();
+                }
+
+                // move every live slot of one old group into the next table. copy first, then bury,
+                // so a reader that miss the key in the old table find it in the next one.
+                // false when next has no free slot on the probe path of a key : that slot stay in the old table.
+                constexpr bool migrate_group(table_type& tbl, table_type& next, size_t at) noexcept
+                {
+                    group_type& grp = tbl.m_group[at];
+                    for (size_t pos { }; pos < group_type::slot_size(); ++pos)
+                    {
+                        if (hash_map_detail::is_free(grp.m_ctrl[pos].load(std::memory_order::acquire)))
+                        { continue; }
+                        const K key = grp.m_key[pos].load(std::memory_order::relaxed);
+                        const size_t hash = hash_of(key);
+                        quota guard {m_stripe[stripe_of(hash)].ref()};
+                        if (hash_map_detail::is_free(grp.m_ctrl[pos].load(std::memory_order::acquire)))
+                        { continue; }
+                        if (!place(next, key, grp.m_value[pos].load(std::memory_order::relaxed), hash))
+                        { return false; }
+                        bury(tbl, position{at, pos, true});
+                    }
+                    return true;
+                }
+
+                // writers leave room in next for every live entry the old table may still hold (and one place in flight per stripe),
+                // so migration always find a free slot.
+                constexpr bool has_room(table_type& next) noexcept
+                {
+                    return next.m_used->load(std::memory_order::relaxed) + m_size->load(std::memory_order::relaxed) + StripeNum < next.capacity();
+                }
+
+                // migrate a chunk of groups. the thread that finish the last chunk publish the next table.
+                constexpr void help(table_type& tbl, table_type& next)
+                {
+                    const size_t begin = tbl.m_cursor->fetch_add(migrate_chunk(), std::memory_order::relaxed);
+                    if (begin >= tbl.m_group_num)
+                    { return; }
+                    const size_t end = std::min(begin + migrate_chunk(), tbl.m_group_num);
+                    for (size_t at = begin; at < end; ++at)
+                    {
+                        // has_room make a failure unexpected. retry until erased slots free the probe path.
+                        while (!migrate_group(tbl, next, at))
+                        { std::this_thread::yield(); }
+                    }
+                    if (tbl.m_done.fetch_add(end - begin, std::memory_order::acq_rel) + (end - begin) == tbl.m_group_num)
+                    {
+                        m_table.store(&next, std::memory_order::release);
+                        m_epoch.retire(&tbl);
+                    }
+                }
+
+                constexpr void grow(table_type& tbl)
+                {
+                    quota guard {m_resize};
+                    if (m_table.load(std::memory_order::acquire) != &tbl || tbl.m_next.load(std::memory_order::acquire) != nullptr)
+                    { return; }
+                    // size from the live entries : a table crowded mainly by tombstones (erase churn) is rehashed at the same size.
+                    const bool churn = m_size->load(std::memory_order::relaxed) * 2 < tbl.capacity();
+                    table_type* next = new table_type(churn ? tbl.m_group_num : tbl.m_group_num * 2);
+                    // a writer holding a stripe either finished on the old table or will see m_next.
+                    for (auto& elem : m_stripe) { elem->lock(); }
+                    tbl.m_next.store(next, std::memory_order::release);
+                    for (auto& elem : m_stripe) { elem->unlock(); }
+                }
+
+                // run op(table, next) with the key's stripe held, after helping any pending growth.
+                template <typename Op>
+                constexpr auto write(size_t hash, Op&& op)
+                {
+                    quota epoch_guard {m_epoch};
+                    while (true)
+                    {
+                        table_type* tbl = m_table.load(std::memory_order::acquire);
+                        table_type* next = tbl->m_next.load(std::memory_order::acquire);
+                        if (next != nullptr)
+                        {
+                            help(*tbl, *next);
+                            if (next->is_crowded())
+                            { continue; }
+                        }
+                        else if (tbl->is_crowded())
+                        {
+                            grow(*tbl);
+                            continue;
+                        }
+
+                        {
+                            quota guard {m_stripe[stripe_of(hash)].ref()};
+                            if (m_table.load(std::memory_order::acquire) != tbl || tbl->m_next.load(std::memory_order::acquire) != next)
+                            { continue; }
+                            if (auto ret = op(*tbl, next); ret.has_value())
+                            { return *ret; }
+                            // no free slot on the probe path. force growth and retry.
+                            if (next == nullptr) { tbl->m_used->store(tbl->capacity(), std::memory_order::relaxed); }
+                            else if (has_room(*next)) { next->m_used->store(next->capacity(), std::memory_order::relaxed); }
+                        }
+                        // no room left for the migration : let it finish (helping) rather than growing a table not yet published.
+                        if (next != nullptr && !has_room(*next))
+                        { std::this_thread::yield(); }
+                    }
+                }
+
+                static constexpr std::optional<bool> placed(bool arg) noexcept
+                { return arg ? std::optional<bool>{true} : std::nullopt; }
+
+            public:
+                hash_map(size_t capacity = 64, const Hash& hash = Hash{ }, const KeyEqual& equal = KeyEqual{ })
+                    : m_table(new table_type(round_groups(capacity * 4 / 3 + 1))), m_size(0), m_stripe(), m_resize(), m_epoch(), m_functor(splits::one_v, hash, equal)
+                { }
+
+                hash_map(const hash_map&) = delete;
+                hash_map(hash_map&&) = delete;
+                hash_map& operator=(const hash_map&) = delete;
+                hash_map& operator=(hash_map&&) = delete;
+
+                ~hash_map() noexcept
+                {
+                    table_type* tbl = m_table.load(std::memory_order::acquire);
+                    delete tbl->m_next.load(std::memory_order::acquire);
+                    delete tbl;
+                }
+
+                // a miss is retried on the current table when the table changed during the lookup,
+                // since a key can move more than one table ahead while this thread read.
+                constexpr bool find(const K& key, V& out)
+                {
+                    const size_t hash = hash_of(key);
+                    quota guard {m_epoch};
+                    table_type* tbl = m_table.load(std::memory_order::acquire);
+                    while (true)
+                    {
+                        if (search(*tbl, key, hash, out))
+                        { return true; }
+                        table_type* next = tbl->m_next.load(std::memory_order::acquire);
+                        if (next != nullptr && search(*next, key, hash, out))
+                        { return true; }
+                        table_type* now = m_table.load(std::memory_order::acquire);
+                        if (now == tbl)
+                        { return false; }
+                        tbl = now;
+                    }
+                }
+
+                constexpr bool contains(const K& key)
+                {
+                    V out { };
+                    return find(key, out);
+                }
+
+                // false when key already exist (value untouched).
+                constexpr bool insert(const K& key, const V& value)
+                {
+                    const size_t hash = hash_of(key);
+                    return write(hash,
+                        [this, &key, &value, hash] (table_type& tbl, table_type* next) -> std::optional<bool>
+                        {
+                            table_type& target = next == nullptr ? tbl : *next;
+                            if (locate(tbl, key, hash).m_found || (next != nullptr && locate(*next, key, hash).m_found))
+                            { return false; }
+                            if ((next != nullptr && !has_room(*next)) || !place(target, key, value, hash))
+                            { return std::nullopt; }
+                            m_size->fetch_add(1, std::memory_order::relaxed);
+                            return true;
+                        });
+                }
+
+                // true when inserted, false when assigned.
+                constexpr bool insert_or_assign(const K& key, const V& value)
+                {
+                    const size_t hash = hash_of(key);
+                    return write(hash,
+                        [this, &key, &value, hash] (table_type& tbl, table_type* next) -> std::optional<bool>
+                        {
+                            position old = locate(tbl, key, hash);
+                            if (next == nullptr)
+                            {
+                                if (old.m_found) { assign(tbl, old, value); return false; }
+                                if (!place(tbl, key, value, hash)) { return std::nullopt; }
+                                m_size->fetch_add(1, std::memory_order::relaxed);
+                                return true;
+                            }
+                            if (position pos = locate(*next, key, hash); pos.m_found)
+                            { assign(*next, pos, value); return false; }
+                            if (!has_room(*next) || !place(*next, key, value, hash))
+                            { return std::nullopt; }
+                            if (old.m_found) { bury(tbl, old); return false; }
+                            m_size->fetch_add(1, std::memory_order::relaxed);
+                            return true;
+                        });
+                }
+
+                constexpr bool erase(const K& key)
+                {
+                    const size_t hash = hash_of(key);
+                    return write(hash,
+                        [this, &key, hash] (table_type& tbl, table_type* next) -> std::optional<bool>
+                        {
+                            bool ret { };
+                            if (next != nullptr)
+                            {
+                                if (position pos = locate(*next, key, hash); pos.m_found) { bury(*next, pos); ret = true; }
+                            }
+                            if (position pos = locate(tbl, key, hash); pos.m_found) { bury(tbl, pos); ret = true; }
+                            if (ret) { m_size->fetch_sub(1, std::memory_order::relaxed); }
+                            return ret;
+                        });
+                }
+
+                constexpr size_t size(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return m_size->load(mem_order); }
+
+                constexpr size_t capacity()
+                {
+                    quota guard {m_epoch};
+                    return m_table.load(std::memory_order::acquire)->capacity();
+                }
+
+                // give this thread's epoch record to the next thread (done at thread exit too, call it to hand the record over earlier).
+                constexpr void detach() noexcept
+                { m_epoch.detach(); }
+        };
+    } // namespace concurrency
+} // namespace sia
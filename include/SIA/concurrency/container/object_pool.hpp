@@ -0,0 +1,286 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/container/stack.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace object_pool_detail
+        {
+            // reset a released object : arg.reset() or arg.clear() when T has one, nothing otherwise.
+            struct default_reset
+            {
+                template <typename T>
+                constexpr void operator()(T& arg) const noexcept(noexcept(arg.reset()))
+                    requires (requires (T& elem) { elem.reset(); })
+                { arg.reset(); }
+
+                template <typename T>
+                constexpr void operator()(T& arg) const noexcept(noexcept(arg.clear()))
+                    requires (!requires (T& elem) { elem.reset(); } && requires (T& elem) { elem.clear(); })
+                { arg.clear(); }
+
+                template <typename T>
+                constexpr void operator()(T&) const noexcept
+                    requires (!requires (T& elem) { elem.reset(); } && !requires (T& elem) { elem.clear(); })
+                { }
+            };
+
+            struct cache;
+
+            // a pooled object. constructed once, destroyed only with the pool.
+            template <typename T>
+            struct node : public stack_hook
+            {
+                T m_value;
+                node* m_next;   // free list of the owner cache / every node of the pool
+                node* m_all;
+                cache* m_owner;
+
+                template <typename... Tys>
+                constexpr node(Tys&&... args)
+                    : stack_hook(), m_value(std::forward<Tys>(args)...), m_next(nullptr), m_all(nullptr), m_owner(nullptr)
+                { }
+            };
+
+            // per-thread free list. only the owner touch it.
+            struct cache
+            {
+                void* m_free = nullptr;
+                size_t m_count = 0;
+            };
+        } // namespace object_pool_detail
+
+        template <typename Pool>
+        struct pooled;
+
+        // pool of constructed objects. a released object is reset (Reset) and kept constructed for the next acquire,
+        // so the hot path pay neither allocation nor construction.
+        // each thread keep a free list (thread_record_list) touched without atomic operation.
+        // objects released by another thread than the one that acquired them go through a lock-free stack,
+        // which a thread take whole when its own list is empty. a thread list over 2 * CacheSize move CacheSize objects there at once.
+        // objects are handed out as pooled<> handles (RAII), they must not outlive the pool.
+        template <typename T, typename Reset = object_pool_detail::default_reset, size_t CacheSize = 64, typename Allocator = std::allocator<T>>
+            requires ((CacheSize > 0) && std::is_invocable_v<const Reset&, T&>)
+        struct object_pool
+        {
+                template <typename Pool>
+                friend struct pooled;
+            public:
+                using value_type = T;
+                using node_type = object_pool_detail::node<T>;
+                using handle_type = pooled<object_pool>;
+
+            private:
+                using cache_type = object_pool_detail::cache;
+                using allocator_type = std::allocator_traits<Allocator>::template rebind_alloc<node_type>;
+                using allocator_traits_t = std::allocator_traits<allocator_type>;
+
+                compressed_pair<allocator_type, Reset> m_compair;
+                intrusive_stack<node_type> m_shared;
+                true_share<std::atomic<node_type*>> m_all;
+                true_share<std::atomic<size_t>> m_size;
+                thread_record_list<cache_type> m_caches;
+
+                constexpr allocator_type& get_allocator() noexcept { return m_compair.first(); }
+                constexpr const Reset& get_reset() noexcept { return m_compair.second(); }
+
+                static constexpr node_type* pop_local(cache_type& local) noexcept
+                {
+                    node_type* ret = static_cast<node_type*>(local.m_free);
+                    if (ret != nullptr)
+                    {
+                        local.m_free = ret->m_next;
+                        --local.m_count;
+                    }
+                    return ret;
+                }
+
+                constexpr void push_local(cache_type& local, node_type* target) noexcept
+                {
+                    target->m_next = static_cast<node_type*>(local.m_free);
+                    local.m_free = target;
+                    if (++local.m_count < 2 * CacheSize)
+                    { return; }
+                    node_type* first = static_cast<node_type*>(local.m_free);
+                    node_type* last = first;
+                    for (size_t count = 1; count < CacheSize; ++count)
+                    {
+                        last->m_stack_next.store(last->m_next, std::memory_order::relaxed);
+                        last = last->m_next;
+                    }
+                    local.m_free = last->m_next;
+                    local.m_count -= CacheSize;
+                    m_shared.push_chain(first, last);
+                }
+
+                // take every object other threads gave back.
+                constexpr node_type* refill(cache_type& local) noexcept
+                {
+                    node_type* at = m_shared.pop_all();
+                    if (at == nullptr)
+                    { return nullptr; }
+                    node_type* ret = at;
+                    at = intrusive_stack<node_type>::next_of(at);
+                    while (at != nullptr)
+                    {
+                        node_type* next = intrusive_stack<node_type>::next_of(at);
+                        at->m_next = static_cast<node_type*>(local.m_free);
+                        local.m_free = at;
+                        ++local.m_count;
+                        at = next;
+                    }
+                    return ret;
+                }
+
+                template <typename... Tys>
+                constexpr node_type* make_node(Tys&&... args)
+                {
+                    node_type* ret = allocator_traits_t::allocate(get_allocator(), 1);
+                    try { std::construct_at(ret, std::forward<Tys>(args)...); }
+                    catch (...) { allocator_traits_t::deallocate(get_allocator(), ret, 1); throw; }
+                    ret->m_all = m_all->load(std::memory_order::relaxed);
+                    while (!m_all->compare_exchange_weak(ret->m_all, ret, std::memory_order::release, std::memory_order::relaxed)) { }
+                    m_size->fetch_add(1, std::memory_order::relaxed);
+                    return ret;
+                }
+
+                constexpr void give_back(node_type* target)
+                {
+                    get_reset()(target->m_value);
+                    cache_type& local = m_caches.local();
+                    if (target->m_owner == &local)
+                    { push_local(local, target); }
+                    else
+                    { m_shared.push(target); }
+                }
+
+            public:
+                constexpr object_pool(const Reset& reset = Reset{ }, const Allocator& alloc = Allocator{ })
+                    : m_compair(splits::one_v, alloc, reset), m_shared(), m_all(nullptr), m_size(0), m_caches()
+                { }
+
+                object_pool(const object_pool&) = delete;
+                object_pool(object_pool&&) = delete;
+                object_pool& operator=(const object_pool&) = delete;
+                object_pool& operator=(object_pool&&) = delete;
+
+                // every pooled object is destroyed, handles still out become dangling.
+                ~object_pool() noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    for (node_type* at = m_all->load(std::memory_order::acquire); at != nullptr;)
+                    {
+                        node_type* next = at->m_all;
+                        std::destroy_at(at);
+                        allocator_traits_t::deallocate(get_allocator(), at, 1);
+                        at = next;
+                    }
+                }
+
+                // objects made so far (in use or pooled).
+                constexpr size_t size(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return m_size->load(mem_order); }
+
+                // a pooled object, or a new one constructed from args when the pool is dry (args are ignored otherwise).
+                template <typename... Tys>
+                constexpr handle_type acquire(Tys&&... args)
+                {
+                    cache_type& local = m_caches.local();
+                    node_type* ret = pop_local(local);
+                    if (ret == nullptr) { ret = refill(local); }
+                    if (ret == nullptr) { ret = make_node(std::forward<Tys>(args)...); }
+                    ret->m_owner = &local;
+                    return handle_type{*this, ret};
+                }
+
+                // construct count objects ahead, into this thread's list.
+                template <typename... Tys>
+                constexpr void reserve(size_t count, const Tys&... args)
+                {
+                    cache_type& local = m_caches.local();
+                    for (size_t idx { }; idx < count; ++idx)
+                    {
+                        node_type* target = make_node(args...);
+                        target->m_owner = &local;
+                        push_local(local, target);
+                    }
+                }
+
+                // give this thread's list to the shared stack (call before thread exit on thread churn).
+                constexpr void detach() noexcept
+                {
+                    cache_type& local = m_caches.local();
+                    while (node_type* at = pop_local(local))
+                    { m_shared.push(at); }
+                    m_caches.release();
+                }
+        };
+
+        // unique handle of a pooled object. the object go back to the pool when the handle is destroyed or reset.
+        template <typename Pool>
+        struct pooled
+        {
+            private:
+                using value_type = Pool::value_type;
+                using node_type = Pool::node_type;
+
+                Pool* m_pool;
+                node_type* m_node;
+
+            public:
+                constexpr pooled() noexcept
+                    : m_pool(nullptr), m_node(nullptr)
+                { }
+
+                constexpr pooled(Pool& pool, node_type* node) noexcept
+                    : m_pool(&pool), m_node(node)
+                { }
+
+                constexpr pooled(pooled&& arg) noexcept
+                    : m_pool(std::exchange(arg.m_pool, nullptr)), m_node(std::exchange(arg.m_node, nullptr))
+                { }
+
+                constexpr pooled& operator=(pooled&& arg)
+                {
+                    if (this != &arg)
+                    {
+                        reset();
+                        m_pool = std::exchange(arg.m_pool, nullptr);
+                        m_node = std::exchange(arg.m_node, nullptr);
+                    }
+                    return *this;
+                }
+
+                pooled(const pooled&) = delete;
+                pooled& operator=(const pooled&) = delete;
+
+                ~pooled()
+                { reset(); }
+
+                constexpr void reset()
+                {
+                    if (m_node != nullptr)
+                    {
+                        m_pool->give_back(m_node);
+                        m_node = nullptr;
+                        m_pool = nullptr;
+                    }
+                }
+
+                constexpr value_type* get() const noexcept { return m_node == nullptr ? nullptr : &m_node->m_value; }
+                constexpr value_type& operator*() const noexcept { return m_node->m_value; }
+                constexpr value_type* operator->() const noexcept { return &m_node->m_value; }
+                constexpr explicit operator bool() const noexcept { return m_node != nullptr; }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -438,6 +438,12 @@ namespace sia
                         { return false; }
                         else
                         {
+                            if constexpr (base_type::is_multiple_producer())
+                            {
+                                // end can pass a slot whose producer has not finished constructing yet.
+                                auto state_comp_ptr = comp.get_state_composition_data() + beg_counter.offset();
+                                state_comp_ptr->action_wait(state_comp_ptr->get_last_action(), ring_detail::ring_action_state::pushed);
+                            }
                             T* target = comp.get_data() + beg_counter.offset();
                             if constexpr (std::is_assignable_v<Ty, T&&>) { arg = std::move(*target); }
                             else { arg = *target; }
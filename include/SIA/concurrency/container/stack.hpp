@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/internals/define.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        struct stack_hook
+        {
+            std::atomic<stack_hook*> m_stack_next;
+        };
+
+        namespace stack_detail
+        {
+            // head word with ABA tag.
+            // x64 user space pointers fit in 48 bits, so the tag is packed in the upper 16 bits (single word CAS).
+            // other architectures fall back to a pointer + counter pair (double word CAS where available).
+            template <bool Packed = (stamps::system::arch_v == tags::arch::x64)>
+            struct tagged_ptr;
+
+            template <>
+            struct tagged_ptr<true>
+            {
+                private:
+                    static constexpr std::uintptr_t ptr_mask() noexcept { return (std::uintptr_t{1} << 48) - 1; }
+                    std::uintptr_t m_value;
+
+                    constexpr tagged_ptr(std::uintptr_t value) noexcept : m_value(value) { }
+
+                public:
+                    constexpr tagged_ptr() noexcept = default;
+                    constexpr stack_hook* ptr() const noexcept { return reinterpret_cast<stack_hook*>(m_value & ptr_mask()); }
+                    constexpr std::uintptr_t tag() const noexcept { return m_value >> 48; }
+                    constexpr tagged_ptr next(stack_hook* arg) const noexcept
+                    { return tagged_ptr{(reinterpret_cast<std::uintptr_t>(arg) & ptr_mask()) | ((tag() + 1) << 48)}; }
+                    static constexpr tagged_ptr make(stack_hook* arg) noexcept
+                    { return tagged_ptr{reinterpret_cast<std::uintptr_t>(arg)}; }
+            };
+
+            template <>
+            struct tagged_ptr<false>
+            {
+                private:
+                    stack_hook* m_ptr;
+                    std::uintptr_t m_tag;
+
+                    constexpr tagged_ptr(stack_hook* ptr, std::uintptr_t tag) noexcept : m_ptr(ptr), m_tag(tag) { }
+
+                public:
+                    constexpr tagged_ptr() noexcept = default;
+                    constexpr stack_hook* ptr() const noexcept { return m_ptr; }
+                    constexpr std::uintptr_t tag() const noexcept { return m_tag; }
+                    constexpr tagged_ptr next(stack_hook* arg) const noexcept { return tagged_ptr{arg, m_tag + 1}; }
+                    static constexpr tagged_ptr make(stack_hook* arg) noexcept { return tagged_ptr{arg, 0}; }
+            };
+        } // namespace stack_detail
+
+        // lock-free intrusive LIFO (treiber stack).
+        // popped nodes are read (m_stack_next) by racing poppers, so node memory must stay valid while the stack is in use.
+        // recycled memory (freelists, pools) fits this, otherwise pair with epoch_domain / hazard_domain.
+        template <typename T = stack_hook>
+            requires (std::is_base_of_v<stack_hook, T>)
+        struct intrusive_stack
+        {
+            private:
+                using tagged_type = stack_detail::tagged_ptr<>;
+                using atomic_type = std::atomic<tagged_type>;
+
+                true_share<atomic_type> m_head;
+
+                static constexpr stack_hook* hook(T* arg) noexcept { return static_cast<stack_hook*>(arg); }
+                static constexpr T* node(stack_hook* arg) noexcept { return static_cast<T*>(arg); }
+
+            public:
+                constexpr intrusive_stack() noexcept
+                    : m_head(tagged_type::make(nullptr))
+                { }
+
+                intrusive_stack(const intrusive_stack&) = delete;
+                intrusive_stack(intrusive_stack&&) = delete;
+                intrusive_stack& operator=(const intrusive_stack&) = delete;
+                intrusive_stack& operator=(intrusive_stack&&) = delete;
+
+                static constexpr bool is_lock_free() noexcept { return atomic_type::is_always_lock_free; }
+
+                constexpr bool is_empty(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return m_head->load(mem_order).ptr() == nullptr; }
+
+                // push pre-linked chain [first ~ last] with one CAS.
+                constexpr void push_chain(T* first, T* last) noexcept
+                {
+                    tagged_type head = m_head->load(std::memory_order::relaxed);
+                    do
+                    { hook(last)->m_stack_next.store(head.ptr(), std::memory_order::relaxed); }
+                    while (!m_head->compare_exchange_weak(head, head.next(hook(first)), std::memory_order::release, std::memory_order::relaxed));
+                }
+
+                constexpr void push(T* arg) noexcept
+                { push_chain(arg, arg); }
+
+                constexpr T* pop() noexcept
+                {
+                    tagged_type head = m_head->load(std::memory_order::acquire);
+                    while (head.ptr() != nullptr)
+                    {
+                        stack_hook* next = head.ptr()->m_stack_next.load(std::memory_order::relaxed);
+                        if (m_head->compare_exchange_weak(head, head.next(next), std::memory_order::acquire, std::memory_order::acquire))
+                        { return node(head.ptr()); }
+                    }
+                    return nullptr;
+                }
+
+                // detach whole chain. follow m_stack_next until nullptr.
+                constexpr T* pop_all() noexcept
+                {
+                    tagged_type head = m_head->load(std::memory_order::acquire);
+                    while (head.ptr() != nullptr && !m_head->compare_exchange_weak(head, head.next(nullptr), std::memory_order::acquire, std::memory_order::acquire)) { }
+                    return head.ptr() == nullptr ? nullptr : node(head.ptr());
+                }
+
+                static constexpr T* next_of(T* arg) noexcept
+                {
+                    stack_hook* next = hook(arg)->m_stack_next.load(std::memory_order::relaxed);
+                    return next == nullptr ? nullptr : node(next);
+                }
+        };
+
+        namespace stack_detail
+        {
+            template <typename T>
+            struct value_node : public stack_hook
+            {
+                alignas(T) byte_t m_storage[sizeof(T)];
+                constexpr T* ptr() noexcept { return reinterpret_cast<T*>(m_storage); }
+            };
+        } // namespace stack_detail
+
+        // lock-free LIFO of values. nodes are recycled through an internal intrusive freelist
+        // and returned to the allocator only on destruction, which keeps intrusive_stack's memory rule.
+        template <typename T, typename Allocator = std::allocator<T>>
+        struct stack
+        {
+            private:
+                using node_type = stack_detail::value_node<T>;
+                using allocator_type = std::allocator_traits<Allocator>::template rebind_alloc<node_type>;
+                using allocator_traits_t = std::allocator_traits<allocator_type>;
+                using intrusive_type = intrusive_stack<node_type>;
+
+                compressed_pair<allocator_type, intrusive_type> m_compair;
+                intrusive_type m_spare;
+
+                constexpr allocator_type& get_allocator() noexcept { return m_compair.first(); }
+                constexpr intrusive_type& get_used() noexcept { return m_compair.second(); }
+
+                constexpr node_type* make_node()
+                {
+                    node_type* ret = m_spare.pop();
+                    if (ret == nullptr)
+                    {
+                        ret = allocator_traits_t::allocate(get_allocator(), 1);
+                        std::construct_at(ret);
+                    }
+                    return ret;
+                }
+
+                constexpr void free_chain(node_type* at, bool has_value) noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    while (at != nullptr)
+                    {
+                        node_type* next = intrusive_type::next_of(at);
+                        if (has_value) { std::destroy_at(at->ptr()); }
+                        std::destroy_at(at);
+                        allocator_traits_t::deallocate(get_allocator(), at, 1);
+                        at = next;
+                    }
+                }
+
+            public:
+                constexpr stack(const Allocator& alloc = Allocator{ }) noexcept
+                    : m_compair(splits::one_v, alloc), m_spare()
+                { }
+
+                stack(const stack&) = delete;
+                stack(stack&&) = delete;
+                stack& operator=(const stack&) = delete;
+                stack& operator=(stack&&) = delete;
+
+                constexpr ~stack() noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    free_chain(get_used().pop_all(), true);
+                    free_chain(m_spare.pop_all(), false);
+                }
+
+                static constexpr bool is_lock_free() noexcept { return intrusive_type::is_lock_free(); }
+
+                constexpr bool is_empty(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return get_used().is_empty(mem_order); }
+
+                template <typename... Tys>
+                constexpr void emplace(Tys&&... args)
+                {
+                    node_type* target = make_node();
+                    if constexpr (std::is_nothrow_constructible_v<T, Tys...>)
+                    { std::construct_at(target->ptr(), std::forward<Tys>(args)...); }
+                    else
+                    {
+                        try { std::construct_at(target->ptr(), std::forward<Tys>(args)...); }
+                        catch (...) { m_spare.push(target); throw; }
+                    }
+                    get_used().push(target);
+                }
+
+                constexpr void push(const T& arg) { emplace(arg); }
+                constexpr void push(T&& arg) { emplace(std::move(arg)); }
+
+                template <typename Ty>
+                    requires (std::is_assignable_v<Ty, T&> || std::is_assignable_v<Ty, T&&>)
+                constexpr bool try_pop(Ty&& arg)
+                    noexcept
+                    (
+                        std::is_nothrow_destructible_v<T> &&
+                        ((std::is_assignable_v<Ty, T&&> && std::is_nothrow_assignable_v<Ty, T&&>) ||
+                        (!std::is_assignable_v<Ty, T&&> && std::is_assignable_v<Ty, T&> && std::is_nothrow_assignable_v<Ty, T&>))
+                    )
+                {
+                    node_type* target = get_used().pop();
+                    if (target == nullptr)
+                    { return false; }
+                    if constexpr (std::is_assignable_v<Ty, T&&>) { arg = std::move(*target->ptr()); }
+                    else { arg = *target->ptr(); }
+                    std::destroy_at(target->ptr());
+                    m_spare.push(target);
+                    return true;
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+#include "SIA/concurrency/container/ring.hpp"
+#include "SIA/concurrency/container/stack.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace staging_detail
+        {
+            using clock_type = std::chrono::steady_clock;
+
+            // records of one lane. travel through the ring as a single pointer.
+            template <typename T, size_t LaneSize>
+            struct batch : public stack_hook
+            {
+                size_t m_size;
+                alignas(T) byte_t m_storage[sizeof(T) * LaneSize];
+
+                constexpr T* ptr(size_t idx) noexcept { return reinterpret_cast<T*>(m_storage) + idx; }
+                constexpr bool is_full() const noexcept { return m_size == LaneSize; }
+                constexpr bool is_empty() const noexcept { return m_size == 0; }
+
+                constexpr void clear() noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    std::destroy_n(ptr(0), m_size);
+                    m_size = 0;
+                }
+            };
+
+            template <typename T, size_t LaneSize>
+            struct lane
+            {
+                batch<T, LaneSize>* m_batch;
+                clock_type::time_point m_since;
+            };
+        } // namespace staging_detail
+
+        // aggregation front-end of an mpsc ring.
+        // each producer fill its own lane (thread_record_list) and publish the whole lane as one ring element,
+        // so the multi-producer claim is paid once per LaneSize records instead of once per record.
+        // a lane is published when full, when its oldest record is older than the timeout (checked on push),
+        // or when the producer call idle() / flush(). producers that may stop pushing must call idle(),
+        // records in a lane are not visible to the consumer until then.
+        // drained batches are recycled through a lock-free stack and freed only with the staging.
+        template <typename T, size_t LaneSize = 32, size_t RingSize = 256, typename Allocator = std::allocator<T>>
+            requires ((LaneSize > 0) && (RingSize > 0))
+        struct staging
+        {
+            private:
+                using batch_type = staging_detail::batch<T, LaneSize>;
+                using lane_type = staging_detail::lane<T, LaneSize>;
+                using clock_type = staging_detail::clock_type;
+                using allocator_type = std::allocator_traits<Allocator>::template rebind_alloc<batch_type>;
+                using allocator_traits_t = std::allocator_traits<allocator_type>;
+                using ring_type = ring<batch_type*, RingSize, tags::producer::multiple, tags::consumer::single>;
+
+                compressed_pair<allocator_type, std::chrono::nanoseconds> m_compair;
+                ring_type m_ring;
+                intrusive_stack<batch_type> m_spare;
+                thread_record_list<lane_type> m_lanes;
+
+                constexpr allocator_type& get_allocator() noexcept { return m_compair.first(); }
+                constexpr std::chrono::nanoseconds timeout() noexcept { return m_compair.second(); }
+
+                constexpr batch_type* make_batch()
+                {
+                    batch_type* ret = m_spare.pop();
+                    if (ret == nullptr)
+                    {
+                        ret = allocator_traits_t::allocate(get_allocator(), 1);
+                        std::construct_at(ret);
+                    }
+                    ret->m_size = 0;
+                    return ret;
+                }
+
+                constexpr void free_batch(batch_type* at) noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    at->clear();
+                    std::destroy_at(at);
+                    allocator_traits_t::deallocate(get_allocator(), at, 1);
+                }
+
+                constexpr bool publish(lane_type& local) noexcept
+                {
+                    if (local.m_batch == nullptr || local.m_batch->is_empty())
+                    { return true; }
+                    if (!m_ring.try_push_back(local.m_batch))
+                    { return false; }
+                    local.m_batch = nullptr;
+                    return true;
+                }
+
+                constexpr bool is_expired(lane_type& local) noexcept
+                {
+                    return timeout().count() != 0 && local.m_batch != nullptr && !local.m_batch->is_empty()
+                        && clock_type::now() - local.m_since >= timeout();
+                }
+
+            public:
+                // timeout 0 : publish only when full or on flush / idle.
+                constexpr staging(std::chrono::nanoseconds timeout = std::chrono::microseconds{100}, const Allocator& alloc = Allocator{ })
+                    : m_compair(splits::one_v, alloc, timeout), m_ring(), m_spare(), m_lanes()
+                { }
+
+                staging(const staging&) = delete;
+                staging(staging&&) = delete;
+                staging& operator=(const staging&) = delete;
+                staging& operator=(staging&&) = delete;
+
+                // records never consumed are destroyed.
+                ~staging() noexcept(std::is_nothrow_destructible_v<T>)
+                {
+                    batch_type* at = nullptr;
+                    while (m_ring.try_extract_front(at))
+                    { free_batch(at); }
+                    m_lanes.for_each(
+                        [this] (lane_type& elem)
+                        {
+                            if (elem.m_batch != nullptr) { free_batch(elem.m_batch); }
+                        });
+                    for (at = m_spare.pop_all(); at != nullptr;)
+                    {
+                        batch_type* next = intrusive_stack<batch_type>::next_of(at);
+                        free_batch(at);
+                        at = next;
+                    }
+                }
+
+                static constexpr size_t lane_size() noexcept { return LaneSize; }
+                static constexpr size_t capacity() noexcept { return LaneSize * RingSize; }
+
+                // stage one record. false only when the lane is full and the ring is full (the record is not stored).
+                template <typename... Tys>
+                constexpr bool try_emplace(Tys&&... args)
+                {
+                    lane_type& local = m_lanes.local();
+                    if (local.m_batch != nullptr && local.m_batch->is_full() && !publish(local))
+                    { return false; }
+                    if (local.m_batch == nullptr)
+                    { local.m_batch = make_batch(); }
+                    batch_type& target = *local.m_batch;
+                    std::construct_at(target.ptr(target.m_size), std::forward<Tys>(args)...);
+                    if (target.m_size++ == 0 && timeout().count() != 0)
+                    { local.m_since = clock_type::now(); }
+                    if (target.is_full() || is_expired(local))
+                    { publish(local); }
+                    return true;
+                }
+
+                constexpr bool try_push(const T& arg) { return try_emplace(arg); }
+                constexpr bool try_push(T&& arg) { return try_emplace(std::move(arg)); }
+
+                // stage one record, yield while the ring is full.
+                template <typename... Tys>
+                constexpr void emplace(Tys&&... args)
+                {
+                    while (!try_emplace(std::forward<Tys>(args)...))
+                    { wait<tags::wait::yield>(); }
+                }
+
+                constexpr void push(const T& arg) { emplace(arg); }
+                constexpr void push(T&& arg) { emplace(std::move(arg)); }
+
+                // publish this thread's lane now. false when the ring is full.
+                constexpr bool flush()
+                { return publish(m_lanes.local()); }
+
+                // idle hook for producers : publish this thread's lane, yield while the ring is full.
+                constexpr void idle()
+                {
+                    lane_type& local = m_lanes.local();
+                    while (!publish(local))
+                    { wait<tags::wait::yield>(); }
+                }
+
+                // publish only when the lane outlived the timeout. cheap enough for a producer's poll loop.
+                constexpr bool poll()
+                {
+                    lane_type& local = m_lanes.local();
+                    return is_expired(local) ? publish(local) : true;
+                }
+
+                // publish and give this thread's lane back (call before thread exit on thread churn).
+                constexpr void detach()
+                {
+                    idle();
+                    lane_type& local = m_lanes.local();
+                    if (local.m_batch != nullptr)
+                    {
+                        m_spare.push(local.m_batch);
+                        local.m_batch = nullptr;
+                    }
+                    m_lanes.release();
+                }
+
+                // single consumer. func(T&) for every record of up to max_batch published lanes, in lane order.
+                // return the number of records consumed.
+                template <typename Func>
+                    requires (std::is_invocable_v<Func, T&>)
+                constexpr size_t consume(Func&& func, size_t max_batch = RingSize)
+                {
+                    size_t ret { };
+                    batch_type* at = nullptr;
+                    for (size_t count { }; count < max_batch && m_ring.try_extract_front(at); ++count)
+                    {
+                        for (size_t idx { }; idx < at->m_size; ++idx)
+                        { func(*at->ptr(idx)); }
+                        ret += at->m_size;
+                        at->clear();
+                        m_spare.push(at);
+                    }
+                    return ret;
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
+#include "SIA/concurrency/utility/scalero.hpp"
+
+namespace sia
+{
+    namespace barrier_detail
+    {
+        struct empty_completion
+        { constexpr void operator()() noexcept { } };
+    } // namespace barrier_detail
+
+    // centralized sense-reversing barrier. the last arriver runs the completion and flips the lever.
+    template <typename CompletionFunc = barrier_detail::empty_completion>
+        requires (std::is_invocable_v<CompletionFunc&>)
+    struct barrier
+    {
+        private:
+            using atomic_type = std::atomic<size_t>;
+
+            compressed_pair<CompletionFunc, size_t> m_compair;
+            true_share<atomic_type> m_count;
+            true_share<lever> m_sense;
+
+            constexpr size_t expect() noexcept { return m_compair.second(); }
+            constexpr void complete() noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            {
+                m_compair.first()();
+                m_count->store(expect(), std::memory_order::relaxed);
+                m_sense->action(std::memory_order::release, std::memory_order::relaxed);
+                m_sense->notify_all();
+            }
+
+        public:
+            using arrival_token = size_t;
+
+            constexpr barrier(size_t count, CompletionFunc func = CompletionFunc{ }) noexcept(std::is_nothrow_move_constructible_v<CompletionFunc>)
+                : m_compair(splits::one_v, std::move(func), count), m_count(count), m_sense()
+            { }
+
+            barrier(const barrier&) = delete;
+            barrier(barrier&&) = delete;
+            barrier& operator=(const barrier&) = delete;
+            barrier& operator=(barrier&&) = delete;
+
+            [[nodiscard]]
+            constexpr arrival_token arrive() noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            {
+                arrival_token token = m_sense->status(std::memory_order::acquire);
+                if (m_count->fetch_sub(1, std::memory_order::acq_rel) == 1)
+                { complete(); }
+                return token;
+            }
+
+            constexpr bool try_wait(arrival_token token) noexcept
+            { return m_sense->status(std::memory_order::acquire) != token; }
+
+            constexpr void wait(arrival_token token) noexcept
+            { m_sense->wait(token, std::memory_order::acquire); }
+
+            constexpr void arrive_and_wait() noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            { wait(arrive()); }
+
+            constexpr size_t capacity() noexcept { return expect(); }
+    };
+
+    template <typename CompletionFunc>
+    barrier(size_t, CompletionFunc) -> barrier<CompletionFunc>;
+
+    // combining tree barrier for high thread counts.
+    // each thread arrives with its own index in [0, Size), waits on its own node for its children,
+    // reports to its parent and the root runs the completion and releases everyone through one lever.
+    template <size_t Size, typename CompletionFunc = barrier_detail::empty_completion, size_t Fanin = 4>
+        requires ((Size > 0) && (Fanin > 1) && std::is_invocable_v<CompletionFunc&>)
+    struct tree_barrier
+    {
+        private:
+            using atomic_type = std::atomic<size_t>;
+
+            compressed_pair<CompletionFunc, true_share<lever>> m_compair;
+            true_share<atomic_type> m_node[Size];
+
+            static constexpr size_t parent(size_t idx) noexcept { return (idx - 1) / Fanin; }
+            static constexpr size_t children(size_t idx) noexcept
+            {
+                size_t first = (idx * Fanin) + 1;
+                if (first >= Size)
+                { return 0; }
+                else if (Size - first < Fanin)
+                { return Size - first; }
+                else
+                { return Fanin; }
+            }
+
+            constexpr lever& sense() noexcept { return m_compair.second().ref(); }
+
+            constexpr void gather(size_t idx) noexcept
+            {
+                atomic_type& node = m_node[idx].ref();
+                const size_t expect = children(idx);
+                for (size_t arrived = node.load(std::memory_order::acquire); arrived != expect; arrived = node.load(std::memory_order::acquire))
+                { spin_park(node, arrived, std::memory_order::acquire); }
+                node.store(0, std::memory_order::relaxed);
+            }
+
+        public:
+            using arrival_token = size_t;
+
+            constexpr tree_barrier(CompletionFunc func = CompletionFunc{ }) noexcept(std::is_nothrow_move_constructible_v<CompletionFunc>)
+                : m_compair(splits::one_v, std::move(func)), m_node()
+            { }
+
+            tree_barrier(const tree_barrier&) = delete;
+            tree_barrier(tree_barrier&&) = delete;
+            tree_barrier& operator=(const tree_barrier&) = delete;
+            tree_barrier& operator=(tree_barrier&&) = delete;
+
+            static constexpr size_t capacity() noexcept { return Size; }
+
+            [[nodiscard]]
+            constexpr arrival_token arrive(size_t idx) noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            {
+                assertm(idx < Size, "Error : tree_barrier index out of range");
+                arrival_token token = sense().status(std::memory_order::acquire);
+                gather(idx);
+                if (idx != 0)
+                {
+                    atomic_type& up = m_node[parent(idx)].ref();
+                    up.fetch_add(1, std::memory_order::release);
+                    up.notify_one();
+                }
+                else
+                {
+                    m_compair.first()();
+                    sense().action(std::memory_order::release, std::memory_order::relaxed);
+                    sense().notify_all();
+                }
+                return token;
+            }
+
+            constexpr bool try_wait(arrival_token token) noexcept
+            { return sense().status(std::memory_order::acquire) != token; }
+
+            constexpr void wait(arrival_token token) noexcept
+            { sense().wait(token, std::memory_order::acquire); }
+
+            constexpr void arrive_and_wait(size_t idx) noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            { wait(arrive(idx)); }
+    };
+} // namespace sia
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace combiner_detail
+        {
+            enum class state : size_t { empty, pending, done };
+
+            template <typename T>
+            struct record
+            {
+                true_share<std::atomic<state>> m_state;
+                void (*m_op)(T&, void*) noexcept;
+                void* m_ctx;
+            };
+
+            template <typename T, typename Func>
+            struct context
+            {
+                using result_type = std::invoke_result_t<Func, T&>;
+                using storage_type = std::conditional_t<std::is_void_v<result_type>, bool, std::optional<result_type>>;
+
+                Func& m_func;
+                storage_type m_result;
+                std::exception_ptr m_error;
+
+                static void invoke(T& data, void* ptr) noexcept
+                {
+                    context& ctx = *static_cast<context*>(ptr);
+                    try
+                    {
+                        if constexpr (std::is_void_v<result_type>) { std::invoke(ctx.m_func, data); }
+                        else { ctx.m_result.emplace(std::invoke(ctx.m_func, data)); }
+                    }
+                    catch (...)
+                    { ctx.m_error = std::current_exception(); }
+                }
+
+                constexpr result_type get()
+                {
+                    if (m_error) { std::rethrow_exception(m_error); }
+                    if constexpr (!std::is_void_v<result_type>) { return std::move(*m_result); }
+                }
+            };
+        } // namespace combiner_detail
+
+        // flat combining adapter for a sequential structure.
+        // each thread publish its operation in its own padded record, and the thread holding the combiner lock
+        // run every pending operation in one batch. the structure stay in the combiner's cache
+        // and N lock handoffs become one.
+        // operations must not call execute of the same combiner.
+        template <typename T, size_t Passes = 2>
+            requires (Passes > 0)
+        struct combiner
+        {
+            private:
+                using record_type = combiner_detail::record<T>;
+                using state = combiner_detail::state;
+
+                true_share<sia::mutex> m_lock;
+                T m_data;
+                thread_record_list<record_type> m_records;
+
+                constexpr void combine() noexcept
+                {
+                    for (size_t pass { }; pass < Passes; ++pass)
+                    {
+                        size_t served { };
+                        m_records.for_each(
+                            [this, &served] (record_type& rec) noexcept
+                            {
+                                if (rec.m_state->load(std::memory_order::acquire) == state::pending)
+                                {
+                                    rec.m_op(m_data, rec.m_ctx);
+                                    rec.m_state->store(state::done, std::memory_order::release);
+                                    ++served;
+                                }
+                            });
+                        if (served == 0)
+                        { break; }
+                    }
+                }
+
+            public:
+                template <typename... Tys>
+                constexpr combiner(Tys&&... args) noexcept(std::is_nothrow_constructible_v<T, Tys...>)
+                    : m_lock(), m_data(std::forward<Tys>(args)...), m_records()
+                { }
+
+                combiner(const combiner&) = delete;
+                combiner(combiner&&) = delete;
+                combiner& operator=(const combiner&) = delete;
+                combiner& operator=(combiner&&) = delete;
+
+                // run func(data) under the combiner and return its result. exceptions are rethrown in the caller.
+                template <typename Func>
+                    requires (std::is_invocable_v<Func, T&> && !std::is_reference_v<std::invoke_result_t<Func, T&>>)
+                constexpr std::invoke_result_t<Func, T&> execute(Func&& func)
+                {
+                    using context_type = combiner_detail::context<T, std::remove_reference_t<Func>>;
+                    assertm(!m_lock->is_own(std::memory_order::relaxed), "Error : recursive combiner execute");
+                    context_type ctx {func, { }, { }};
+                    record_type& rec = m_records.local();
+                    rec.m_op = &context_type::invoke;
+                    rec.m_ctx = &ctx;
+                    rec.m_state->store(state::pending, std::memory_order::release);
+
+                    while (true)
+                    {
+                        if (m_lock->try_lock(std::memory_order::acquire))
+                        {
+                            combine();
+                            m_lock->unlock(std::memory_order::release);
+                        }
+                        for (size_t count { }; count < stamps::basis::spin_loop_val && rec.m_state->load(std::memory_order::acquire) == state::pending; ++count) { }
+                        if (rec.m_state->load(std::memory_order::acquire) == state::done)
+                        { break; }
+                        wait<tags::wait::yield>();
+                    }
+                    rec.m_state->store(state::empty, std::memory_order::relaxed);
+                    return ctx.get();
+                }
+
+                // direct access without combining. caller must guarantee no concurrent execute.
+                constexpr T& data() noexcept { return m_data; }
+
+                // give this thread's record to the next thread (done at thread exit too, call it to hand the record over earlier).
+                constexpr void detach() noexcept
+                { m_records.release(); }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+#include "SIA/concurrency/utility/retire.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace epoch_detail
+        {
+            // epoch state word : (epoch << 1) | active
+            constexpr size_t active_bit() noexcept { return 1; }
+            constexpr size_t pack(size_t epoch) noexcept { return (epoch << 1) | active_bit(); }
+            constexpr size_t unpack(size_t state) noexcept { return state >> 1; }
+            constexpr bool is_active(size_t state) noexcept { return (state & active_bit()) != 0; }
+
+            constexpr size_t bin_num() noexcept { return 3; }
+
+            struct limbo
+            {
+                size_t m_epoch;
+                retire_list m_list;
+            };
+
+            struct record
+            {
+                true_share<std::atomic<size_t>> m_state;
+                size_t m_nest;
+                size_t m_retired;
+                limbo m_limbo[bin_num()];
+            };
+        } // namespace epoch_detail
+
+        // epoch based reclamation domain.
+        // a thread in critical section (lock ~ unlock) can read any node reachable when it entered.
+        // retired nodes wait in the per-thread limbo bin of their epoch and are freed two epochs later.
+        // lock / unlock / try_lock / is_own make the domain usable with sia::quota as a scoped guard.
+        template <size_t BatchSize = 64>
+            requires (BatchSize > 0)
+        struct epoch_domain
+        {
+            private:
+                using record_type = epoch_detail::record;
+
+                true_share<std::atomic<size_t>> m_epoch;
+                thread_record_list<record_type> m_records;
+
+                constexpr std::atomic<size_t>& state(record_type& rec) noexcept { return rec.m_state.ref(); }
+
+                constexpr bool try_advance() noexcept
+                {
+                    size_t epoch = m_epoch->load(std::memory_order::relaxed);
+                    std::atomic_thread_fence(std::memory_order::seq_cst);
+                    bool ready = true;
+                    // acquire : pair with the release stores of lock / unlock, so the sections a reader left are ordered before the advance.
+                    m_records.for_each(
+                        [this, epoch, &ready] (record_type& rec) noexcept
+                        {
+                            size_t tmp = state(rec).load(std::memory_order::acquire);
+                            if (epoch_detail::is_active(tmp) && epoch_detail::unpack(tmp) != epoch)
+                            { ready = false; }
+                        });
+                    if (!ready)
+                    { return false; }
+                    std::atomic_thread_fence(std::memory_order::acquire);
+                    return m_epoch->compare_exchange_strong(epoch, epoch + 1, std::memory_order::release, std::memory_order::relaxed);
+                }
+
+                constexpr void collect(record_type& rec) noexcept
+                {
+                    try_advance();
+                    size_t epoch = m_epoch->load(std::memory_order::relaxed);
+                    for (epoch_detail::limbo& bin : rec.m_limbo)
+                    {
+                        if (!bin.m_list.is_empty() && bin.m_epoch + 2 <= epoch)
+                        { bin.m_list.reclaim(); }
+                    }
+                }
+
+            public:
+                constexpr epoch_domain() noexcept
+                    : m_epoch(0), m_records()
+                { }
+
+                epoch_domain(const epoch_domain&) = delete;
+                epoch_domain(epoch_domain&&) = delete;
+                epoch_domain& operator=(const epoch_domain&) = delete;
+                epoch_domain& operator=(epoch_domain&&) = delete;
+
+                // enter critical section. nestable.
+                // the first call of a thread can allocate its record : std::bad_alloc leave the thread outside (a quota guard throw too).
+                constexpr void lock(std::memory_order = std::memory_order::seq_cst)
+                {
+                    record_type& rec = m_records.local();
+                    if (rec.m_nest++ == 0)
+                    {
+                        // release : a plain store does not continue the release sequence of the unlock store,
+                        // so a collector that read this state would not be ordered after the previous section.
+                        state(rec).store(epoch_detail::pack(m_epoch->load(std::memory_order::relaxed)), std::memory_order::release);
+                        std::atomic_thread_fence(std::memory_order::seq_cst);
+                    }
+                }
+
+                constexpr bool try_lock(std::memory_order mem_order = std::memory_order::seq_cst)
+                {
+                    lock(mem_order);
+                    return true;
+                }
+
+                constexpr void unlock(std::memory_order = std::memory_order::seq_cst)
+                {
+                    record_type& rec = m_records.local();
+                    if (--rec.m_nest == 0)
+                    {
+                        std::atomic<size_t>& target = state(rec);
+                        target.store(target.load(std::memory_order::relaxed) & ~epoch_detail::active_bit(), std::memory_order::release);
+                    }
+                }
+
+                constexpr bool is_own(std::memory_order = std::memory_order::seq_cst)
+                { return m_records.local().m_nest != 0; }
+
+                // defer deletion of an already unlinked node.
+                constexpr void retire(void* ptr, deleter_t deleter)
+                {
+                    quota guard {*this};
+                    record_type& rec = m_records.local();
+                    size_t epoch = m_epoch->load(std::memory_order::relaxed);
+                    epoch_detail::limbo& bin = rec.m_limbo[epoch % epoch_detail::bin_num()];
+                    if (bin.m_epoch != epoch)
+                    {
+                        // this bin hold epoch - 3 (or older). always safe.
+                        bin.m_list.reclaim();
+                        bin.m_epoch = epoch;
+                    }
+                    bin.m_list.push_back(ptr, deleter);
+                    if (++rec.m_retired >= BatchSize)
+                    {
+                        rec.m_retired = 0;
+                        collect(rec);
+                    }
+                }
+
+                template <typename T>
+                constexpr void retire(T* ptr)
+                { retire(ptr, &retire_detail::default_deleter<T>); }
+
+                // try advance the global epoch and free whatever this thread can.
+                constexpr void reclaim()
+                { collect(m_records.local()); }
+
+                // wait for a full grace period and free this thread's limbo bins.
+                // must not be called inside critical section.
+                constexpr void synchronize()
+                {
+                    record_type& rec = m_records.local();
+                    const size_t target = m_epoch->load(std::memory_order::relaxed) + 2;
+                    while (m_epoch->load(std::memory_order::relaxed) < target)
+                    {
+                        if (!try_advance())
+                        { std::this_thread::yield(); }
+                    }
+                    collect(rec);
+                }
+
+                constexpr size_t epoch(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                { return m_epoch->load(mem_order); }
+
+                // give this thread's record (and its pending limbo) to the next thread that needs one.
+                constexpr void detach() noexcept
+                { m_records.release(); }
+        };
+
+        template <size_t BatchSize = 64>
+        using epoch_guard = quota<epoch_domain<BatchSize>>;
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
+
+namespace sia
+{
+    namespace event_count_detail
+    {
+        // state word : (epoch << 32) | waiter count
+        constexpr std::uint64_t waiter_mask() noexcept { return 0xffff'ffffULL; }
+        constexpr std::uint64_t epoch_unit() noexcept { return std::uint64_t{1} << 32; }
+        constexpr std::uint32_t epoch_of(std::uint64_t state) noexcept { return static_cast<std::uint32_t>(state >> 32); }
+    } // namespace event_count_detail
+
+    // condition signalling for lock-free structures.
+    // waiter : key = prepare_wait(), recheck the condition, then cancel_wait() or commit_wait(key).
+    // notifier : publish the change, then notify(). notify is a fence and a load when nobody wait.
+    struct event_count
+    {
+        private:
+            std::atomic<std::uint64_t> m_state;
+
+            void signal(bool all) noexcept
+            {
+                std::atomic_thread_fence(std::memory_order::seq_cst);
+                if ((m_state.load(std::memory_order::relaxed) & event_count_detail::waiter_mask()) == 0)
+                { return; }
+                m_state.fetch_add(event_count_detail::epoch_unit(), std::memory_order::acq_rel);
+                if (all) { m_state.notify_all(); }
+                else { m_state.notify_one(); }
+            }
+
+        public:
+            using key_type = std::uint32_t;
+
+            constexpr event_count() noexcept
+                : m_state(0)
+            { static_assert(std::atomic<std::uint64_t>::is_always_lock_free); }
+
+            event_count(const event_count&) = delete;
+            event_count(event_count&&) = delete;
+            event_count& operator=(const event_count&) = delete;
+            event_count& operator=(event_count&&) = delete;
+
+            // register as waiter. the condition must be checked again after this.
+            key_type prepare_wait() noexcept
+            { return event_count_detail::epoch_of(m_state.fetch_add(1, std::memory_order::seq_cst)); }
+
+            // condition became true after prepare_wait.
+            void cancel_wait() noexcept
+            { m_state.fetch_sub(1, std::memory_order::seq_cst); }
+
+            // sleep until a notify after prepare_wait.
+            template <tags::wait WaitTag = tags::wait::busy>
+            constexpr void commit_wait(key_type key) noexcept(tools_detail::is_wait_nothrow<WaitTag>())
+            {
+                std::uint64_t tmp = m_state.load(std::memory_order::acquire);
+                while (event_count_detail::epoch_of(tmp) == key)
+                {
+                    spin_park<WaitTag>(m_state, tmp, std::memory_order::acquire);
+                    tmp = m_state.load(std::memory_order::acquire);
+                }
+                m_state.fetch_sub(1, std::memory_order::relaxed);
+            }
+
+            void notify_one() noexcept
+            { signal(false); }
+
+            void notify_all() noexcept
+            { signal(true); }
+
+            void notify() noexcept
+            { signal(true); }
+
+            size_t waiter(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            { return static_cast<size_t>(m_state.load(mem_order) & event_count_detail::waiter_mask()); }
+
+            // block until pred() is true.
+            template <tags::wait WaitTag = tags::wait::busy, typename Pred>
+                requires (std::is_invocable_r_v<bool, Pred>)
+            constexpr void await(Pred&& pred)
+            {
+                while (!pred())
+                {
+                    const key_type key = prepare_wait();
+                    if (pred())
+                    {
+                        cancel_wait();
+                        return;
+                    }
+                    commit_wait<WaitTag>(key);
+                }
+            }
+    };
+} // namespace sia
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <bit>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/retire.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace hazard_detail
+        {
+            template <size_t SlotNum>
+            struct record
+            {
+                true_share<std::atomic<void*>> m_slot[SlotNum];
+                size_t m_used;
+                retire_list m_retired;
+            };
+        } // namespace hazard_detail
+
+        template <typename Domain>
+        struct hazard_pointer;
+
+        // hazard pointer domain. a published slot keep one node alive for as long as it is held,
+        // without blocking reclamation of anything else. better fit than epoch for long-held references.
+        template <size_t SlotNum = 2, size_t BatchSize = 64>
+            requires ((SlotNum > 0) && (SlotNum <= sizeof(size_t) * 8) && (BatchSize > 0))
+        struct hazard_domain
+        {
+            private:
+                template <typename Domain>
+                friend struct hazard_pointer;
+                using record_type = hazard_detail::record<SlotNum>;
+
+                thread_record_list<record_type> m_records;
+
+                constexpr std::atomic<void*>& acquire_slot()
+                {
+                    record_type& rec = m_records.local();
+                    assertm(rec.m_used != ~size_t{ } >> (sizeof(size_t) * 8 - SlotNum), "Error : hazard slots exhausted");
+                    size_t pos = std::countr_one(rec.m_used);
+                    rec.m_used |= size_t{1} << pos;
+                    return rec.m_slot[pos].ref();
+                }
+
+                constexpr void release_slot(std::atomic<void*>& slot)
+                {
+                    record_type& rec = m_records.local();
+                    slot.store(nullptr, std::memory_order::release);
+                    for (size_t pos { }; pos < SlotNum; ++pos)
+                    {
+                        if (&rec.m_slot[pos].ref() == &slot)
+                        { rec.m_used &= ~(size_t{1} << pos); }
+                    }
+                }
+
+                constexpr void scan(record_type& rec)
+                {
+                    std::vector<void*> hazards { };
+                    std::atomic_thread_fence(std::memory_order::seq_cst);
+                    m_records.for_each(
+                        [&hazards] (record_type& elem)
+                        {
+                            for (auto& slot : elem.m_slot)
+                            {
+                                void* ptr = slot->load(std::memory_order::acquire);
+                                if (ptr != nullptr) { hazards.push_back(ptr); }
+                            }
+                        });
+                    std::sort(hazards.begin(), hazards.end());
+                    rec.m_retired.reclaim_unless([&hazards] (void* ptr) noexcept { return std::binary_search(hazards.begin(), hazards.end(), ptr); });
+                }
+
+            public:
+                constexpr hazard_domain() noexcept = default;
+
+                hazard_domain(const hazard_domain&) = delete;
+                hazard_domain(hazard_domain&&) = delete;
+                hazard_domain& operator=(const hazard_domain&) = delete;
+                hazard_domain& operator=(hazard_domain&&) = delete;
+
+                static constexpr size_t slot_size() noexcept { return SlotNum; }
+
+                // defer deletion of an already unlinked node until no slot publish it.
+                constexpr void retire(void* ptr, deleter_t deleter)
+                {
+                    record_type& rec = m_records.local();
+                    rec.m_retired.push_back(ptr, deleter);
+                    if (rec.m_retired.size() >= BatchSize)
+                    { scan(rec); }
+                }
+
+                template <typename T>
+                constexpr void retire(T* ptr)
+                { retire(ptr, &retire_detail::default_deleter<T>); }
+
+                constexpr void reclaim()
+                { scan(m_records.local()); }
+
+                constexpr void detach() noexcept
+                { m_records.release(); }
+        };
+
+        // scoped ownership of one hazard slot of this thread.
+        template <typename Domain>
+        struct hazard_pointer
+        {
+            private:
+                Domain& m_domain;
+                std::atomic<void*>& m_slot;
+
+            public:
+                constexpr hazard_pointer(Domain& domain)
+                    : m_domain(domain), m_slot(domain.acquire_slot())
+                { }
+
+                hazard_pointer(const hazard_pointer&) = delete;
+                hazard_pointer(hazard_pointer&&) = delete;
+                hazard_pointer& operator=(const hazard_pointer&) = delete;
+                hazard_pointer& operator=(hazard_pointer&&) = delete;
+
+                ~hazard_pointer()
+                { m_domain.release_slot(m_slot); }
+
+                // publish src until it is stable. the returned node stay alive until reset or destruction.
+                template <typename T>
+                constexpr T* protect(const std::atomic<T*>& src) noexcept
+                {
+                    T* ptr = src.load(std::memory_order::relaxed);
+                    while (true)
+                    {
+                        m_slot.store(ptr, std::memory_order::seq_cst);
+                        T* again = src.load(std::memory_order::acquire);
+                        if (again == ptr)
+                        { return ptr; }
+                        ptr = again;
+                    }
+                }
+
+                template <typename T>
+                constexpr bool try_protect(T*& ptr, const std::atomic<T*>& src) noexcept
+                {
+                    m_slot.store(ptr, std::memory_order::seq_cst);
+                    T* again = src.load(std::memory_order::acquire);
+                    if (again == ptr)
+                    { return true; }
+                    ptr = again;
+                    return false;
+                }
+
+                constexpr void reset(void* ptr = nullptr) noexcept
+                { m_slot.store(ptr, std::memory_order::release); }
+        };
+
+        template <typename Domain>
+        hazard_pointer(Domain&) -> hazard_pointer<Domain>;
+    } // namespace concurrency
+} // namespace sia
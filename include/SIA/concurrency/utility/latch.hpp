@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/barrier.hpp"
+#include "SIA/concurrency/utility/scalero.hpp"
+
+namespace sia
+{
+    // single-use latch. the thread which counts down to zero runs the completion and opens the gate.
+    template <typename CompletionFunc = barrier_detail::empty_completion>
+        requires (std::is_invocable_v<CompletionFunc&>)
+    struct latch
+    {
+        private:
+            using atomic_type = std::atomic<size_t>;
+
+            compressed_pair<CompletionFunc, true_share<atomic_type>> m_compair;
+            true_share<lever> m_gate;
+
+            constexpr atomic_type& counter() noexcept { return m_compair.second().ref(); }
+
+        public:
+            constexpr latch(size_t count, CompletionFunc func = CompletionFunc{ }) noexcept(std::is_nothrow_move_constructible_v<CompletionFunc>)
+                : m_compair(splits::one_v, std::move(func), count), m_gate()
+            {
+                if (count == 0)
+                { m_gate->action(std::memory_order::relaxed, std::memory_order::relaxed); }
+            }
+
+            latch(const latch&) = delete;
+            latch(latch&&) = delete;
+            latch& operator=(const latch&) = delete;
+            latch& operator=(latch&&) = delete;
+
+            constexpr void count_down(size_t num = 1) noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            {
+                if (counter().fetch_sub(num, std::memory_order::acq_rel) == num)
+                {
+                    m_compair.first()();
+                    m_gate->action(std::memory_order::release, std::memory_order::relaxed);
+                    m_gate->notify_all();
+                }
+            }
+
+            constexpr bool try_wait() noexcept
+            { return m_gate->status(std::memory_order::acquire) != 0; }
+
+            constexpr void wait() noexcept
+            { m_gate->wait(0, std::memory_order::acquire); }
+
+            constexpr void arrive_and_wait(size_t num = 1) noexcept(std::is_nothrow_invocable_v<CompletionFunc&>)
+            {
+                count_down(num);
+                wait();
+            }
+    };
+
+    template <typename CompletionFunc>
+    latch(size_t, CompletionFunc) -> latch<CompletionFunc>;
+} // namespace sia
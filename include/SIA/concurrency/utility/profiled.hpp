@@ -0,0 +1,291 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/recorder.hpp"
+#include "SIA/utility/types/constant_string.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+
+namespace sia
+{
+    namespace profile_detail
+    {
+        // bucket 0 : 0 ns, bucket i : [2^(i-1), 2^i) ns, last bucket take the rest.
+        constexpr size_t bucket_num() noexcept { return 48; }
+        constexpr size_t bucket_of(size_t ns) noexcept
+        {
+            const size_t ret = static_cast<size_t>(std::bit_width(ns));
+            return ret < bucket_num() ? ret : bucket_num() - 1;
+        }
+
+        struct histogram
+        {
+            std::atomic<size_t> m_bucket[bucket_num()];
+            std::atomic<size_t> m_count;
+            std::atomic<size_t> m_total_ns;
+            std::atomic<size_t> m_max_ns;
+
+            histogram() noexcept
+                : m_bucket(), m_count(0), m_total_ns(0), m_max_ns(0)
+            { }
+
+            void record(size_t ns) noexcept
+            {
+                m_bucket[bucket_of(ns)].fetch_add(1, std::memory_order::relaxed);
+                m_count.fetch_add(1, std::memory_order::relaxed);
+                m_total_ns.fetch_add(ns, std::memory_order::relaxed);
+                size_t tmp = m_max_ns.load(std::memory_order::relaxed);
+                while (tmp < ns && !m_max_ns.compare_exchange_weak(tmp, ns, std::memory_order::relaxed, std::memory_order::relaxed)) { }
+            }
+
+            void reset() noexcept
+            {
+                for (auto& elem : m_bucket)
+                { elem.store(0, std::memory_order::relaxed); }
+                m_count.store(0, std::memory_order::relaxed);
+                m_total_ns.store(0, std::memory_order::relaxed);
+                m_max_ns.store(0, std::memory_order::relaxed);
+            }
+
+            void dump(std::ostream& os) const
+            {
+                const size_t count = m_count.load(std::memory_order::relaxed);
+                os << "count " << count << ", avg " << (count == 0 ? 0 : m_total_ns.load(std::memory_order::relaxed) / count)
+                    << " ns, max " << m_max_ns.load(std::memory_order::relaxed) << " ns\n";
+                for (size_t idx { }; idx < bucket_num(); ++idx)
+                {
+                    const size_t num = m_bucket[idx].load(std::memory_order::relaxed);
+                    if (num != 0)
+                    { os << "    < " << (size_t{1} << idx) << " ns : " << num << '\n'; }
+                }
+            }
+        };
+
+        // m_wait : a sampled acquisition is waiting, m_hold : a sampled acquisition is held.
+        struct sample
+        {
+            bool m_wait;
+            bool m_hold;
+            single_recorder<> m_recorder;
+        };
+
+        // quota read value_type of a CheckAble target.
+        template <typename T>
+        struct value_base { };
+        template <typename T>
+            requires (requires { typename T::value_type; })
+        struct value_base<T> { using value_type = T::value_type; };
+    } // namespace profile_detail
+
+    // wait / hold histograms of every lock sharing one name. registered in a global list on construction.
+    struct lock_profile
+    {
+        std::string_view m_name;
+        size_t m_sample_rate;
+        profile_detail::histogram m_wait;
+        profile_detail::histogram m_hold;
+        lock_profile* m_next;
+
+        static std::atomic<lock_profile*>& head() noexcept
+        {
+            static constinit std::atomic<lock_profile*> s_head {nullptr};
+            return s_head;
+        }
+
+        lock_profile(std::string_view name, size_t sample_rate) noexcept
+            : m_name(name), m_sample_rate(sample_rate), m_wait(), m_hold(), m_next(head().load(std::memory_order::relaxed))
+        { while (!head().compare_exchange_weak(m_next, this, std::memory_order::release, std::memory_order::relaxed)) { } }
+
+        lock_profile(const lock_profile&) = delete;
+        lock_profile& operator=(const lock_profile&) = delete;
+
+        void dump(std::ostream& os) const
+        {
+            os << "[" << m_name << "] sampled 1 / " << m_sample_rate << '\n';
+            os << "  wait : ";
+            m_wait.dump(os);
+            os << "  hold : ";
+            m_hold.dump(os);
+        }
+    };
+
+    namespace profile_detail
+    {
+        // constant_string keep the terminating '\0' of the literal.
+        template <auto Name>
+        consteval std::string_view name_of() noexcept
+        { return std::string_view{Name.begin()}; }
+
+        template <auto Name, size_t SampleRate>
+        inline lock_profile profile_v {name_of<Name>(), SampleRate};
+    } // namespace profile_detail
+
+    template <typename Func>
+    void for_each_lock_profile(Func&& func)
+    {
+        for (lock_profile* at = lock_profile::head().load(std::memory_order::acquire); at != nullptr; at = at->m_next)
+        { func(*at); }
+    }
+
+    inline void dump_lock_profile(std::ostream& os)
+    { for_each_lock_profile([&os] (const lock_profile& elem) { elem.dump(os); }); }
+
+    inline void reset_lock_profile() noexcept
+    {
+        for_each_lock_profile(
+            [] (lock_profile& elem) noexcept
+            {
+                elem.m_wait.reset();
+                elem.m_hold.reset();
+            });
+    }
+
+    // profiling wrapper for sia::mutex / semaphore / ticket (and any LockAble, AcquireAble, CheckAble type).
+    // one acquisition in SampleRate (counted per thread) measure its wait and hold time with single_recorder,
+    // the others only pay a thread_local increment. usable with sia::quota like the wrapped type.
+    // the sample state is per thread, so a thread must not hold two locks of the same profiled type at once.
+    template <typename Lock, constant_string Name, size_t SampleRate = 1024>
+        requires (quota_detail::QuotaAble<Lock> && (SampleRate > 0))
+    struct profiled : public profile_detail::value_base<Lock>
+    {
+        private:
+            using sample_type = profile_detail::sample;
+
+            Lock m_lock;
+
+            static lock_profile& profile() noexcept { return profile_detail::profile_v<Name, SampleRate>; }
+
+            static sample_type& local() noexcept
+            {
+                static thread_local sample_type tl_sample { };
+                return tl_sample;
+            }
+
+            static bool roll() noexcept
+            {
+                static thread_local size_t tl_tick { };
+                return ++tl_tick % SampleRate == 0;
+            }
+
+            static void begin_wait() noexcept
+            {
+                sample_type& target = local();
+                target.m_wait = roll();
+                target.m_hold = false;
+                if (target.m_wait) { target.m_recorder.set(); }
+            }
+
+            static void end_wait(bool success) noexcept
+            {
+                sample_type& target = local();
+                if (!target.m_wait)
+                { return; }
+                target.m_recorder.now();
+                profile().m_wait.record(static_cast<size_t>(target.m_recorder.template result<tags::time_unit::nanoseconds>()));
+                target.m_wait = false;
+                target.m_hold = success;
+                if (success) { target.m_recorder.set(); }
+            }
+
+            static void end_hold() noexcept
+            {
+                sample_type& target = local();
+                if (!target.m_hold)
+                { return; }
+                target.m_recorder.now();
+                profile().m_hold.record(static_cast<size_t>(target.m_recorder.template result<tags::time_unit::nanoseconds>()));
+                target.m_hold = false;
+            }
+
+        public:
+            template <typename... Tys>
+            constexpr profiled(Tys&&... args) noexcept(std::is_nothrow_constructible_v<Lock, Tys...>)
+                : m_lock(std::forward<Tys>(args)...)
+            { }
+
+            profiled(const profiled&) = delete;
+            profiled(profiled&&) = delete;
+            profiled& operator=(const profiled&) = delete;
+            profiled& operator=(profiled&&) = delete;
+
+            static constexpr std::string_view name() noexcept { return profile_detail::name_of<Name>(); }
+            static lock_profile& stat() noexcept { return profile(); }
+            constexpr Lock& base() noexcept { return m_lock; }
+
+            // LockAble
+            void lock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::LockAble<Lock>)
+            {
+                begin_wait();
+                m_lock.lock(mem_order);
+                end_wait(true);
+            }
+
+            bool try_lock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::LockAble<Lock>)
+            {
+                begin_wait();
+                const bool ret = m_lock.try_lock(mem_order);
+                end_wait(ret);
+                return ret;
+            }
+
+            void unlock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::LockAble<Lock>)
+            {
+                end_hold();
+                m_lock.unlock(mem_order);
+            }
+
+            bool is_own(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::LockAble<Lock>)
+            { return m_lock.is_own(mem_order); }
+
+            // AcquireAble
+            void acquire(std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+                requires (quota_detail::AcquireAble<Lock>)
+            {
+                begin_wait();
+                m_lock.acquire(rmw_mem_order, load_mem_order);
+                end_wait(true);
+            }
+
+            bool try_acquire(std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+                requires (quota_detail::AcquireAble<Lock>)
+            {
+                begin_wait();
+                const bool ret = m_lock.try_acquire(rmw_mem_order, load_mem_order);
+                end_wait(ret);
+                return ret;
+            }
+
+            auto release(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::AcquireAble<Lock>)
+            {
+                end_hold();
+                return m_lock.release(mem_order);
+            }
+
+            // CheckAble. wait is measured from check_in to the first successful check.
+            auto check_in(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::CheckAble<Lock>)
+            {
+                begin_wait();
+                return m_lock.check_in(mem_order);
+            }
+
+            template <typename Ty>
+            bool check(Ty num, std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::CheckAble<Lock>)
+            {
+                const bool ret = m_lock.check(num, mem_order);
+                if (ret) { end_wait(true); }
+                return ret;
+            }
+
+            void check_out(std::memory_order mem_order = std::memory_order::seq_cst) noexcept requires (quota_detail::CheckAble<Lock>)
+            {
+                end_hold();
+                m_lock.check_out(mem_order);
+            }
+    };
+} // namespace sia
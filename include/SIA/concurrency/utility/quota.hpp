@@ -2,6 +2,9 @@
 
 #include <type_traits>
 #include <atomic>
+#include <utility>
+
+#include "SIA/concurrency/utility/tools.hpp"
 
 namespace sia
 {
@@ -32,10 +35,13 @@ namespace sia
             private:
                 T& m_target;
             public:
+                // a lock that can fail (epoch_domain allocate the thread's record on first use) throw from take.
+                static constexpr bool nothrow_take = noexcept(std::declval<T&>().lock()) && noexcept(std::declval<T&>().try_lock());
+
                 constexpr quota_base(T& arg) noexcept : m_target(arg) { }
-                constexpr bool try_take(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                constexpr bool try_take(std::memory_order mem_order = std::memory_order::seq_cst) noexcept(nothrow_take)
                 { return m_target.try_lock(mem_order); }
-                constexpr void take(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                constexpr void take(std::memory_order mem_order = std::memory_order::seq_cst) noexcept(nothrow_take)
                 { m_target.lock(mem_order); }
                 constexpr void back(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
                 { m_target.unlock(mem_order); }
@@ -84,7 +90,7 @@ namespace sia
                 constexpr quota_base(T& arg, bool flag) noexcept : m_target(arg), m_own(flag), m_hold() { }
 
                 constexpr void wait(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
-                { while (!m_target.check(m_hold, mem_order)) { } }
+                { while (!m_target.check(m_hold, mem_order)) { cpu_relax(); } }
                 constexpr void set_number(value_type arg) noexcept { m_hold = arg; }
                 constexpr bool try_take(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
                 {
@@ -112,8 +118,16 @@ namespace sia
         private:
             using base_type = quota_detail::quota_base<T>;
 
+            static constexpr bool nothrow_init() noexcept
+            {
+                if constexpr (quota_detail::LockAble<T>)
+                { return base_type::nothrow_take; }
+                else
+                { return true; }
+            }
+
             template <typename Ty = size_t>
-            constexpr void init(tags::quota qtag, Ty arg = 0) noexcept
+            constexpr void init(tags::quota qtag, Ty arg = 0) noexcept(nothrow_init())
             {
                 if (qtag == tags::quota::take)
                 { this->base_type::take(); }
@@ -133,7 +147,7 @@ namespace sia
 
         public:
             template <quota_detail::LockAble Ty>
-            constexpr quota(Ty&& arg, tags::quota qtag = tags::quota::take) noexcept
+            constexpr quota(Ty&& arg, tags::quota qtag = tags::quota::take) noexcept(nothrow_init())
                 : base_type(arg)
             { init(qtag); }
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "SIA/internals/types.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace retire_detail
+        {
+            template <typename T>
+            void default_deleter(void* ptr) noexcept { delete static_cast<T*>(ptr); }
+        } // namespace retire_detail
+
+        using deleter_t = void (*)(void*) noexcept;
+
+        struct retired
+        {
+            void* m_ptr;
+            deleter_t m_deleter;
+
+            void reclaim() noexcept { m_deleter(m_ptr); }
+        };
+
+        // deferred deletion bin. deleters may retire again, so the bin is swapped out before it run.
+        struct retire_list
+        {
+            private:
+                std::vector<retired> m_list;
+
+            public:
+                constexpr size_t size() noexcept { return m_list.size(); }
+                constexpr bool is_empty() noexcept { return m_list.empty(); }
+                void push_back(void* ptr, deleter_t deleter) { m_list.push_back(retired{ptr, deleter}); }
+
+                void reclaim() noexcept
+                {
+                    std::vector<retired> target { };
+                    target.swap(m_list);
+                    for (retired& elem : target)
+                    { elem.reclaim(); }
+                }
+
+                // reclaim the entries for which pred(ptr) is false, keep the rest.
+                template <typename Pred>
+                void reclaim_unless(Pred&& pred) noexcept(noexcept(pred(std::declval<void*>())))
+                {
+                    std::vector<retired> target { };
+                    target.swap(m_list);
+                    for (retired& elem : target)
+                    {
+                        if (pred(elem.m_ptr)) { m_list.push_back(elem); }
+                        else { elem.reclaim(); }
+                    }
+                }
+
+                ~retire_list() noexcept { reclaim(); }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -4,11 +4,20 @@
 #include <atomic>
 
 #include "SIA/internals/types.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
 
 namespace sia
 {
+    namespace scalero_detail
+    {
+        template <typename T>
+        concept LockFree = std::atomic<T>::is_always_lock_free;
+        template <typename T, T Max>
+        concept PowerOfTwo = (Max > 0) && ((Max & (Max - 1)) == 0);
+    } // namespace scalero_detail
+
     template <typename T = largest_unsigned_integer_t, T Max = std::numeric_limits<T>::max()>
-        requires (std::atomic<T>::is_always_lock_free)
+        requires (scalero_detail::LockFree<T>)
     struct scalero
     {
         private:
@@ -19,14 +28,65 @@ namespace sia
         public:
             constexpr value_type status(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
             { return m_num.load(mem_order); }
-            
+
             constexpr value_type action(std::memory_order rmw_order = std::memory_order::seq_cst, std::memory_order load_order = std::memory_order::seq_cst) noexcept
             {
                 value_type tmp = m_num.load(load_order);
                 while(!m_num.compare_exchange_weak(tmp, (tmp+1)%Max, rmw_order, load_order)) {}
                 return tmp;
             }
+
+            // advance num steps at once. return the value before.
+            constexpr value_type action_n(value_type num, std::memory_order rmw_order = std::memory_order::seq_cst, std::memory_order load_order = std::memory_order::seq_cst) noexcept
+            {
+                const value_type step = num % Max;
+                value_type tmp = m_num.load(load_order);
+                while(!m_num.compare_exchange_weak(tmp, tmp >= Max - step ? tmp - (Max - step) : tmp + step, rmw_order, load_order)) {}
+                return tmp;
+            }
+
+            constexpr void wait(value_type old, std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            { spin_park(m_num, old, mem_order); }
+            constexpr void notify_one() noexcept { m_num.notify_one(); }
+            constexpr void notify_all() noexcept { m_num.notify_all(); }
+    };
+
+    // power of two Max : the counter run free and is masked on read, so action is one fetch_add (wait-free).
+    template <typename T, T Max>
+        requires (scalero_detail::LockFree<T> && scalero_detail::PowerOfTwo<T, Max>)
+    struct scalero<T, Max>
+    {
+        private:
+            using value_type = T;
+            using atomic_type = std::atomic<value_type>;
+            atomic_type m_num;
+
+            static constexpr value_type mask() noexcept { return Max - 1; }
+
+        public:
+            constexpr value_type status(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            { return m_num.load(mem_order) & mask(); }
+
+            // the load order is unused, kept for the same signature as the generic scalero.
+            constexpr value_type action(std::memory_order rmw_order = std::memory_order::seq_cst, std::memory_order = std::memory_order::seq_cst) noexcept
+            { return m_num.fetch_add(1, rmw_order) & mask(); }
+
+            constexpr value_type action_n(value_type num, std::memory_order rmw_order = std::memory_order::seq_cst, std::memory_order = std::memory_order::seq_cst) noexcept
+            { return m_num.fetch_add(num, rmw_order) & mask(); }
+
+            // the raw counter can differ from old while the masked value is still old.
+            constexpr void wait(value_type old, std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                value_type tmp = m_num.load(mem_order);
+                while ((tmp & mask()) == old)
+                {
+                    spin_park(m_num, tmp, mem_order);
+                    tmp = m_num.load(mem_order);
+                }
+            }
+            constexpr void notify_one() noexcept { m_num.notify_one(); }
+            constexpr void notify_all() noexcept { m_num.notify_all(); }
     };
 
     using lever = scalero<size_t, 2>;
-} // namespace sia
\ No newline at end of file
+} // namespace sia
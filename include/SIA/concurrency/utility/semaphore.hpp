@@ -15,13 +15,32 @@ namespace sia
         private:
             using value_type = T;
             using atomic_type = std::atomic<value_type>;
-            
+            using waiter_type = std::atomic<size_t>;
+
             atomic_type m_count;
+            waiter_type m_waiter;
 
             static constexpr value_type step() noexcept { return value_type{1}; }
+
+            // waiter count and permit count form a dekker pair, both sides must be seq_cst.
+            constexpr void park(value_type num) noexcept
+            {
+                value_type tmp = m_count.load(std::memory_order::seq_cst);
+                if (tmp < num)
+                { m_count.wait(tmp, std::memory_order::seq_cst); }
+            }
+
+            constexpr void wake(std::memory_order mem_order) noexcept
+            {
+                if (mem_order != std::memory_order::seq_cst)
+                { std::atomic_thread_fence(std::memory_order::seq_cst); }
+                if (m_waiter.load(std::memory_order::seq_cst) != 0)
+                { m_count.notify_all(); }
+            }
+
         public:
             constexpr semaphore(value_type init = Limit) noexcept
-                : m_count(init)
+                : m_count(init), m_waiter(0)
             { }
 
             semaphore(const semaphore&) = delete;
@@ -29,25 +48,53 @@ namespace sia
             semaphore& operator=(const semaphore&) = delete;
             semaphore& operator=(semaphore&&) = delete;
 
-            constexpr bool try_acquire(std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+            constexpr bool try_acquire_n(value_type num, std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
             {
                 value_type tmp = m_count.load(load_mem_order);
-                while (tmp != value_type{0})
+                while (tmp >= num)
                 {
-                    if (m_count.compare_exchange_weak(tmp, tmp - step(), rmw_mem_order, load_mem_order))
+                    if (m_count.compare_exchange_weak(tmp, tmp - num, rmw_mem_order, load_mem_order))
                     { return true; }
                 }
                 return false;
             }
 
+            constexpr bool try_acquire(std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+            { return try_acquire_n(step(), rmw_mem_order, load_mem_order); }
+
+            template <tags::loop LoopTag, tags::wait WaitTag, typename LoopTimeType = default_time_rep_t, typename WaitTimeType = default_time_rep_t>
+            constexpr bool try_acquire_n_loop(LoopTimeType ltt_v, WaitTimeType wtt_v, value_type num, std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+            { return loop<LoopTag, WaitTag>(true, ltt_v, wtt_v, &semaphore::try_acquire_n, this, num, rmw_mem_order, load_mem_order); }
+
             template <tags::loop LoopTag, tags::wait WaitTag, typename LoopTimeType = default_time_rep_t, typename WaitTimeType = default_time_rep_t>
             constexpr bool try_acquire_loop(LoopTimeType ltt_v, WaitTimeType wtt_v, std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
-            { return loop<LoopTag, WaitTag>(true, ltt_v, wtt_v, &semaphore::try_acquire, this, rmw_mem_order, load_mem_order); }
+            { return try_acquire_n_loop<LoopTag, WaitTag>(ltt_v, wtt_v, step(), rmw_mem_order, load_mem_order); }
+
+            // spin for a while, then park on m_count until enough permits are released.
+            constexpr void acquire_n(value_type num, std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
+            {
+                if (try_acquire_n_loop<tags::loop::repeat_n, tags::wait::busy>(stamps::basis::spin_loop_val, stamps::basis::empty_wait_val, num, rmw_mem_order, load_mem_order))
+                { return; }
+                m_waiter.fetch_add(1, std::memory_order::seq_cst);
+                while (!try_acquire_n(num, rmw_mem_order, load_mem_order))
+                { park(num); }
+                m_waiter.fetch_sub(1, std::memory_order::relaxed);
+            }
 
             constexpr void acquire(std::memory_order rmw_mem_order = std::memory_order::seq_cst, std::memory_order load_mem_order = std::memory_order::seq_cst) noexcept
-            { try_acquire_loop<tags::loop::busy, tags::wait::busy>(stamps::basis::empty_loop_val, stamps::basis::empty_wait_val, rmw_mem_order, load_mem_order); }
+            { acquire_n(step(), rmw_mem_order, load_mem_order); }
+
+            constexpr value_type release_n(value_type num, std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                value_type ret = m_count.fetch_add(num, mem_order);
+                wake(mem_order);
+                return ret;
+            }
 
             constexpr value_type release(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
-            { return m_count.fetch_add(step(), mem_order); }
+            { return release_n(step(), mem_order); }
+
+            constexpr value_type count(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            { return m_count.load(mem_order); }
     };
 } // namespace sia
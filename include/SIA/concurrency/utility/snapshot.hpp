@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+#include "SIA/concurrency/utility/epoch.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        template <typename Snapshot>
+        struct snapshot_reader;
+
+        // rcu style cell for read-mostly state.
+        // readers enter an epoch section (a store and a fence on their own record, no shared write) and read the current version.
+        // writers publish a whole new version, the old one is deleted after every reader that could see it left.
+        // BatchSize 1 : every publish try to advance the epoch and free the writer's old versions, versions are large and rare.
+        template <typename T, size_t BatchSize = 1>
+        struct snapshot
+        {
+            private:
+                template <typename Snapshot>
+                friend struct snapshot_reader;
+
+                true_share<std::atomic<T*>> m_ptr;
+                sia::mutex m_writer;
+                epoch_domain<BatchSize> m_domain;
+
+                // m_writer is held by the caller.
+                constexpr void publish(T* ptr)
+                {
+                    T* old = m_ptr->exchange(ptr, std::memory_order::acq_rel);
+                    m_domain.retire(old);
+                }
+
+            public:
+                using value_type = T;
+                using reader_type = snapshot_reader<snapshot>;
+
+                template <typename... Tys>
+                constexpr snapshot(Tys&&... args)
+                    : m_ptr(new T(std::forward<Tys>(args)...)), m_writer(), m_domain()
+                { }
+
+                snapshot(const snapshot&) = delete;
+                snapshot(snapshot&&) = delete;
+                snapshot& operator=(const snapshot&) = delete;
+                snapshot& operator=(snapshot&&) = delete;
+
+                ~snapshot() noexcept
+                { delete m_ptr->load(std::memory_order::acquire); }
+
+                // scoped read section. the version stay alive while the reader live.
+                constexpr reader_type read()
+                { return reader_type(*this); }
+
+                template <typename Func>
+                    requires (std::is_invocable_v<Func, const T&>)
+                constexpr decltype(auto) read(Func&& func)
+                {
+                    quota guard {m_domain};
+                    return std::invoke(std::forward<Func>(func), std::as_const(*m_ptr->load(std::memory_order::acquire)));
+                }
+
+                // publish new version (ownership taken). writers are serialized.
+                constexpr void store(T* ptr)
+                {
+                    quota guard {m_writer};
+                    publish(ptr);
+                }
+
+                template <typename... Tys>
+                constexpr void emplace(Tys&&... args)
+                { store(new T(std::forward<Tys>(args)...)); }
+
+                // copy the current version, let func modify the copy and publish it. writers are serialized,
+                // so no store can slip between the copy and the publish.
+                template <typename Func>
+                    requires (std::is_invocable_v<Func, T&>)
+                constexpr void update(Func&& func)
+                {
+                    quota guard {m_writer};
+                    std::unique_ptr<T> next { };
+                    {
+                        quota section {m_domain};
+                        next = std::make_unique<T>(*m_ptr->load(std::memory_order::acquire));
+                    }
+                    std::invoke(std::forward<Func>(func), *next);
+                    publish(next.release());
+                }
+
+                // wait for a grace period and free the versions this thread replaced. must not be called inside a read section.
+                // versions replaced by other writer threads stay in their limbo until they publish or synchronize again.
+                constexpr void synchronize()
+                { m_domain.synchronize(); }
+
+                // give this thread's epoch record to the next thread (done at thread exit too, call it to hand the record over earlier).
+                constexpr void detach() noexcept
+                { m_domain.detach(); }
+        };
+
+        template <typename Snapshot>
+        struct snapshot_reader
+        {
+            private:
+                using value_type = Snapshot::value_type;
+
+                Snapshot& m_target;
+                const value_type* m_ptr;
+
+            public:
+                constexpr snapshot_reader(Snapshot& target)
+                    : m_target(target), m_ptr(nullptr)
+                {
+                    m_target.m_domain.lock();
+                    m_ptr = m_target.m_ptr->load(std::memory_order::acquire);
+                }
+
+                snapshot_reader(const snapshot_reader&) = delete;
+                snapshot_reader(snapshot_reader&&) = delete;
+                snapshot_reader& operator=(const snapshot_reader&) = delete;
+                snapshot_reader& operator=(snapshot_reader&&) = delete;
+
+                ~snapshot_reader()
+                { m_target.m_domain.unlock(); }
+
+                constexpr const value_type* get() const noexcept { return m_ptr; }
+                constexpr const value_type& operator*() const noexcept { return *m_ptr; }
+                constexpr const value_type* operator->() const noexcept { return m_ptr; }
+        };
+    } // namespace concurrency
+} // namespace sia
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace thread_index_detail
+        {
+            // hand out the smallest free index, so live indices stay dense in [0, peak thread count).
+            struct registry
+            {
+                private:
+                    sia::mutex m_lock;
+                    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> m_free;
+                    std::atomic<size_t> m_next;
+
+                public:
+                    registry() noexcept
+                        : m_lock(), m_free(), m_next(0)
+                    { }
+
+                    size_t acquire()
+                    {
+                        quota guard {m_lock};
+                        if (m_free.empty())
+                        { return m_next.fetch_add(1, std::memory_order::relaxed); }
+                        size_t ret = m_free.top();
+                        m_free.pop();
+                        return ret;
+                    }
+
+                    void release(size_t index)
+                    {
+                        quota guard {m_lock};
+                        m_free.push(index);
+                    }
+
+                    size_t peak(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+                    { return m_next.load(mem_order); }
+            };
+
+            inline registry& global() noexcept
+            {
+                static registry s_registry { };
+                return s_registry;
+            }
+
+            struct holder
+            {
+                const size_t m_index;
+
+                holder() : m_index(global().acquire()) { }
+                ~holder() { global().release(m_index); }
+            };
+        } // namespace thread_index_detail
+
+        // dense index of this thread. taken on first call, given back on thread exit and reused by the next thread.
+        inline size_t thread_index()
+        {
+            static thread_local const thread_index_detail::holder tl_holder { };
+            return tl_holder.m_index;
+        }
+
+        // highest index ever handed out + 1.
+        inline size_t thread_index_peak(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+        { return thread_index_detail::global().peak(mem_order); }
+
+        // padded slot per thread, addressed by thread_index().
+        // a slot outlive its thread and is inherited by the next thread that get the same index.
+        // at most Size threads alive at once : local() throw std::length_error for a thread whose index is Size or above.
+        template <typename T, size_t Size = 128>
+            requires (Size > 0)
+        struct per_thread
+        {
+            private:
+                true_share<T> m_slot[Size];
+
+                template <size_t... Seqs, typename... Tys>
+                constexpr per_thread(std::index_sequence<Seqs...>, const Tys&... args)
+                    : m_slot{((void)Seqs, true_share<T>(args...))...}
+                { }
+
+            public:
+                // every slot is constructed from args.
+                template <typename... Tys>
+                constexpr per_thread(const Tys&... args)
+                    : per_thread(std::make_index_sequence<Size>{ }, args...)
+                { }
+
+                per_thread(const per_thread&) = delete;
+                per_thread(per_thread&&) = delete;
+                per_thread& operator=(const per_thread&) = delete;
+                per_thread& operator=(per_thread&&) = delete;
+
+                static constexpr size_t size() noexcept { return Size; }
+
+                constexpr T& local()
+                {
+                    const size_t index = thread_index();
+                    if (index >= Size)
+                    { throw std::length_error{"per_thread : more live threads than slots"}; }
+                    return m_slot[index].ref();
+                }
+
+                constexpr T& operator[](size_t index) noexcept { return m_slot[index].ref(); }
+                constexpr const T& operator[](size_t index) const noexcept { return m_slot[index].ref(); }
+
+                // visit slots of every index handed out so far. slots can be in use by their owner concurrently.
+                template <typename Func>
+                constexpr void for_each(Func&& func) noexcept(noexcept(func(std::declval<T&>())))
+                {
+                    const size_t peak = std::min(thread_index_peak(std::memory_order::acquire), Size);
+                    for (size_t index { }; index < peak; ++index)
+                    { func(m_slot[index].ref()); }
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
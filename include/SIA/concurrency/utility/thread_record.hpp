@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/internals/define.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+
+namespace sia
+{
+    namespace concurrency
+    {
+        namespace thread_record_detail
+        {
+            inline std::atomic<size_t> serial_source {1};
+
+            constexpr size_t cache_num() noexcept { return 64; }
+
+            template <typename Record>
+            struct record_node
+            {
+                Record m_record;
+                std::atomic<thread_id_t> m_owner;
+                record_node* m_next;
+
+                constexpr record_node(thread_id_t owner, record_node* next) noexcept(std::is_nothrow_default_constructible_v<Record>)
+                    : m_record(), m_owner(owner), m_next(next)
+                { }
+            };
+
+            // link of a live list in the registry.
+            struct anchor
+            {
+                anchor* m_prev;
+                anchor* m_next;
+                size_t m_serial;
+            };
+
+            // live lists. a thread release its records at exit only in lists still alive, under m_lock.
+            struct registry
+            {
+                sia::mutex m_lock;
+                anchor m_root {&m_root, &m_root, 0};
+                std::atomic<size_t> m_unlinked {0};   // lists destroyed so far, tell threads their owned entries may be stale.
+
+                void link(anchor& target) noexcept
+                {
+                    quota guard {m_lock};
+                    target.m_prev = &m_root;
+                    target.m_next = m_root.m_next;
+                    m_root.m_next->m_prev = &target;
+                    m_root.m_next = &target;
+                }
+
+                void unlink(anchor& target) noexcept
+                {
+                    quota guard {m_lock};
+                    target.m_prev->m_next = target.m_next;
+                    target.m_next->m_prev = target.m_prev;
+                    m_unlinked.fetch_add(1, std::memory_order::relaxed);
+                }
+
+                // serials of the live lists, sorted. m_lock is held by the caller.
+                std::vector<size_t> live() const
+                {
+                    std::vector<size_t> ret { };
+                    for (const anchor* at = m_root.m_next; at != &m_root; at = at->m_next)
+                    { ret.push_back(at->m_serial); }
+                    std::sort(ret.begin(), ret.end());
+                    return ret;
+                }
+            };
+
+            inline registry& global() noexcept
+            {
+                static registry s_registry { };
+                return s_registry;
+            }
+
+            struct owned
+            {
+                size_t m_serial;
+                std::atomic<thread_id_t>* m_owner;
+                thread_id_t m_tid;
+            };
+
+            // per-thread state shared by every list : a direct mapped cache of this thread's nodes keyed by list serial,
+            // and the records this thread own, given back at thread exit.
+            struct local_table
+            {
+                std::pair<size_t, void*> m_cache[cache_num()] { };
+                std::vector<owned> m_owned;
+                size_t m_prune_at = cache_num();
+                size_t m_seen = 0;  // m_unlinked of the registry at the last prune
+
+                ~local_table()
+                {
+                    if (m_owned.empty())
+                    { return; }
+                    registry& target = global();
+                    quota guard {target.m_lock};
+                    std::vector<size_t> live { };
+                    try { live = target.live(); }
+                    catch (...) { return; } // records stay owned, as with no thread exit release
+                    for (owned& elem : m_owned)
+                    {
+                        thread_id_t tid = elem.m_tid;
+                        if (std::binary_search(live.begin(), live.end(), elem.m_serial))
+                        { elem.m_owner->compare_exchange_strong(tid, thread_id_t{ }, std::memory_order::release, std::memory_order::relaxed); }
+                    }
+                }
+
+                std::pair<size_t, void*>& cache(size_t serial) noexcept
+                { return m_cache[serial % cache_num()]; }
+
+                // a list destroyed by another thread leave its entry here. drop entries of dead lists
+                // when the vector doubled since the last prune and some list was destroyed meanwhile.
+                void remember(owned arg)
+                {
+                    if (m_owned.size() >= m_prune_at)
+                    { prune(); }
+                    m_owned.push_back(arg);
+                }
+
+                void prune()
+                {
+                    registry& target = global();
+                    if (target.m_unlinked.load(std::memory_order::relaxed) != m_seen)
+                    {
+                        quota guard {target.m_lock};
+                        m_seen = target.m_unlinked.load(std::memory_order::relaxed);
+                        const std::vector<size_t> live = target.live();
+                        std::erase_if(m_owned, [&live] (const owned& elem) noexcept { return !std::binary_search(live.begin(), live.end(), elem.m_serial); });
+                    }
+                    m_prune_at = std::max(cache_num(), m_owned.size() * 2);
+                }
+
+                void forget(size_t serial) noexcept
+                {
+                    std::erase_if(m_owned, [serial] (const owned& elem) noexcept { return elem.m_serial == serial; });
+                    if (std::pair<size_t, void*>& slot = cache(serial); slot.first == serial)
+                    { slot = {0, nullptr}; }
+                }
+            };
+
+            inline local_table& local() noexcept
+            {
+                static thread_local local_table tl_table { };
+                return tl_table;
+            }
+        } // namespace thread_record_detail
+
+        // lock-free list of per-thread records keyed by stamps::this_thread::id_v.
+        // nodes are only freed with the list. a released node is adopted by the next thread that needs one,
+        // so the length is bounded by the peak number of threads. records are released at thread exit.
+        // each thread cache its node per list instance (direct mapped by serial), so threads using many lists stay off the scan.
+        template <typename Record>
+        struct thread_record_list
+        {
+            private:
+                using node_type = thread_record_detail::record_node<Record>;
+
+                std::atomic<node_type*> m_head;
+                thread_record_detail::anchor m_anchor;
+
+                constexpr size_t serial() const noexcept { return m_anchor.m_serial; }
+
+                constexpr node_type* find(thread_id_t tid) noexcept
+                {
+                    for (node_type* at = m_head.load(std::memory_order::acquire); at != nullptr; at = at->m_next)
+                    {
+                        if (at->m_owner.load(std::memory_order::relaxed) == tid)
+                        { return at; }
+                    }
+                    return nullptr;
+                }
+
+                constexpr node_type* adopt(thread_id_t tid) noexcept
+                {
+                    for (node_type* at = m_head.load(std::memory_order::acquire); at != nullptr; at = at->m_next)
+                    {
+                        thread_id_t vacant { };
+                        if (at->m_owner.load(std::memory_order::relaxed) == vacant && at->m_owner.compare_exchange_strong(vacant, tid, std::memory_order::acquire, std::memory_order::relaxed))
+                        { return at; }
+                    }
+                    return nullptr;
+                }
+
+                constexpr node_type* attach(thread_id_t tid)
+                {
+                    node_type* at = new node_type(tid, m_head.load(std::memory_order::relaxed));
+                    while (!m_head.compare_exchange_weak(at->m_next, at, std::memory_order::release, std::memory_order::relaxed)) { }
+                    return at;
+                }
+
+                // find, adopt or attach this thread's node and remember it for the thread exit.
+                node_type* take(thread_record_detail::local_table& table)
+                {
+                    const thread_id_t tid = stamps::this_thread::id_v;
+                    node_type* at = find(tid);
+                    if (at == nullptr)
+                    {
+                        at = adopt(tid);
+                        if (at == nullptr) { at = attach(tid); }
+                        try { table.remember({serial(), &at->m_owner, tid}); }
+                        catch (...) { at->m_owner.store(thread_id_t{ }, std::memory_order::release); throw; }
+                    }
+                    return at;
+                }
+
+            public:
+                thread_record_list() noexcept
+                    : m_head(nullptr), m_anchor{nullptr, nullptr, thread_record_detail::serial_source.fetch_add(1, std::memory_order::relaxed)}
+                { thread_record_detail::global().link(m_anchor); }
+
+                thread_record_list(const thread_record_list&) = delete;
+                thread_record_list(thread_record_list&&) = delete;
+                thread_record_list& operator=(const thread_record_list&) = delete;
+                thread_record_list& operator=(thread_record_list&&) = delete;
+
+                ~thread_record_list() noexcept(std::is_nothrow_destructible_v<Record>)
+                {
+                    // exiting threads stop touching the nodes once the list is unlinked.
+                    thread_record_detail::global().unlink(m_anchor);
+                    for (node_type* at = m_head.load(std::memory_order::acquire); at != nullptr;)
+                    {
+                        node_type* next = at->m_next;
+                        delete at;
+                        at = next;
+                    }
+                    thread_record_detail::local().forget(serial());
+                }
+
+                // this thread's record. first call per thread reuse a released record or append a new one.
+                Record& local()
+                {
+                    thread_record_detail::local_table& table = thread_record_detail::local();
+                    std::pair<size_t, void*>& slot = table.cache(serial());
+                    if (slot.first != serial())
+                    { slot = {serial(), take(table)}; }
+                    return static_cast<node_type*>(slot.second)->m_record;
+                }
+
+                // this thread's record, nullptr when it can not be made (allocation failure). for paths that must not throw.
+                Record* try_local() noexcept
+                {
+                    try { return &local(); }
+                    catch (...) { return nullptr; }
+                }
+
+                // give this thread's record back before thread exit. it keep its state for the next owner.
+                void release() noexcept
+                {
+                    thread_record_detail::local_table& table = thread_record_detail::local();
+                    std::pair<size_t, void*>& slot = table.cache(serial());
+                    node_type* at = (slot.first == serial()) ? static_cast<node_type*>(slot.second) : find(stamps::this_thread::id_v);
+                    if (at != nullptr)
+                    { at->m_owner.store(thread_id_t{ }, std::memory_order::release); }
+                    table.forget(serial());
+                }
+
+                // visit every record, owned or not. records can be in use by their owner concurrently.
+                template <typename Func>
+                constexpr void for_each(Func&& func) noexcept(noexcept(func(std::declval<Record&>())))
+                {
+                    for (node_type* at = m_head.load(std::memory_order::acquire); at != nullptr; at = at->m_next)
+                    { func(at->m_record); }
+                }
+
+                constexpr size_t size() noexcept
+                {
+                    size_t ret { };
+                    for (node_type* at = m_head.load(std::memory_order::acquire); at != nullptr; at = at->m_next)
+                    { ++ret; }
+                    return ret;
+                }
+        };
+    } // namespace concurrency
+} // namespace sia
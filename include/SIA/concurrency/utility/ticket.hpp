@@ -2,9 +2,14 @@
 
 #include <atomic>
 #include <limits>
+#include <chrono>
+#include <algorithm>
 
 #include "SIA/internals/types.hpp"
+#include "SIA/utility/compressed_pair.hpp"
 #include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/internals/define.hpp"
+#include "SIA/concurrency/utility/tools.hpp"
 
 namespace sia
 {
@@ -25,4 +30,185 @@ namespace sia
             constexpr bool check(value_type num, std::memory_order mem_order = std::memory_order::seq_cst) noexcept { return m_check->load(mem_order) == num; }
             constexpr void check_out(std::memory_order mem_order = std::memory_order::seq_cst) noexcept { m_check->fetch_add(step(), mem_order); }
     };
+
+    namespace stamps
+    {
+        namespace basis
+        {
+            // pause count per ticket ahead, for ticket_lock proportional backoff.
+            constexpr const size_t ticket_backoff_val = 32;
+        } // namespace basis
+    } // namespace stamps
+
+    struct ticket_stat
+    {
+        size_t m_acquire;
+        size_t m_contended;
+        size_t m_wait_ns;
+        size_t m_max_wait_ns;
+    };
+
+    namespace ticket_detail
+    {
+        // orders given by the caller, made valid for the load that acquire the lock and the store that release it.
+        constexpr std::memory_order acquire_order(std::memory_order mem_order) noexcept
+        { return mem_order == std::memory_order::seq_cst ? std::memory_order::seq_cst : std::memory_order::acquire; }
+
+        constexpr std::memory_order release_order(std::memory_order mem_order) noexcept
+        { return mem_order == std::memory_order::seq_cst ? std::memory_order::seq_cst : std::memory_order::release; }
+
+        template <bool Stat>
+        struct stat_block
+        {
+            using clock_type = std::chrono::steady_clock;
+            using time_point = clock_type::time_point;
+
+            static constexpr time_point start() noexcept { return time_point{ }; }
+            constexpr void record(bool, time_point) noexcept { }
+            constexpr ticket_stat get() noexcept { return ticket_stat{ }; }
+            constexpr void reset() noexcept { }
+        };
+
+        template <>
+        struct stat_block<true>
+        {
+            using clock_type = std::chrono::steady_clock;
+            using time_point = clock_type::time_point;
+
+            true_share<std::atomic<size_t>> m_acquire;
+            std::atomic<size_t> m_contended;
+            std::atomic<size_t> m_wait_ns;
+            std::atomic<size_t> m_max_wait_ns;
+
+            static time_point start() noexcept { return clock_type::now(); }
+
+            // called by the lock holder only, so relaxed read-modify-write is enough.
+            void record(bool contended, time_point begin) noexcept
+            {
+                m_acquire->store(m_acquire->load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+                if (!contended)
+                { return; }
+                const size_t elapsed = static_cast<size_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - begin).count());
+                m_contended.store(m_contended.load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+                m_wait_ns.store(m_wait_ns.load(std::memory_order::relaxed) + elapsed, std::memory_order::relaxed);
+                m_max_wait_ns.store(std::max(m_max_wait_ns.load(std::memory_order::relaxed), elapsed), std::memory_order::relaxed);
+            }
+
+            ticket_stat get() noexcept
+            {
+                return ticket_stat{m_acquire->load(std::memory_order::relaxed), m_contended.load(std::memory_order::relaxed),
+                    m_wait_ns.load(std::memory_order::relaxed), m_max_wait_ns.load(std::memory_order::relaxed)};
+            }
+
+            void reset() noexcept
+            {
+                m_acquire->store(0, std::memory_order::relaxed);
+                m_contended.store(0, std::memory_order::relaxed);
+                m_wait_ns.store(0, std::memory_order::relaxed);
+                m_max_wait_ns.store(0, std::memory_order::relaxed);
+            }
+        };
+    } // namespace ticket_detail
+
+    // fair FIFO lock. a waiter pause in proportion to its distance from the served ticket before polling again.
+    // Partition > 1 spread "now serving" over Partition slots, ticket t poll only slot t % Partition.
+    // Stat record acquisitions and wait time of contended acquisitions (clock is read only when contended).
+    template <size_t Partition = 1, bool Stat = false, typename T = largest_unsigned_integer_t>
+        requires (std::atomic<T>::is_always_lock_free && std::is_unsigned_v<T> && (Partition > 0))
+    struct ticket_lock
+    {
+        public:
+            using value_type = T;
+        private:
+            using atomic_type = std::atomic<value_type>;
+            using stat_type = ticket_detail::stat_block<Stat>;
+
+            true_share<atomic_type> m_next;
+            true_share<atomic_type> m_serving[Partition];
+            compressed_pair<stat_type, std::atomic<thread_id_t>> m_compair;
+            value_type m_hold;
+
+            constexpr atomic_type& serving(value_type num) noexcept { return m_serving[num % Partition].ref(); }
+            constexpr stat_type& get_stat() noexcept { return m_compair.first(); }
+            constexpr std::atomic<thread_id_t>& get_owner() noexcept { return m_compair.second(); }
+
+            void own(value_type num) noexcept
+            {
+                m_hold = num;
+                get_owner().store(stamps::this_thread::id_v, std::memory_order::relaxed);
+            }
+
+        public:
+            ticket_lock() noexcept
+                : m_next(0), m_serving(), m_compair(splits::zero_v, thread_id_t{ }), m_hold(0)
+            {
+                // slot i start one round behind, so only ticket 0 is served.
+                for (size_t idx { }; idx < Partition; ++idx)
+                { m_serving[idx]->store(static_cast<value_type>(idx - Partition), std::memory_order::relaxed); }
+                m_serving[0]->store(0, std::memory_order::relaxed);
+            }
+
+            ticket_lock(const ticket_lock&) = delete;
+            ticket_lock(ticket_lock&&) = delete;
+            ticket_lock& operator=(const ticket_lock&) = delete;
+            ticket_lock& operator=(ticket_lock&&) = delete;
+
+            bool try_lock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                value_type num = m_next->load(std::memory_order::relaxed);
+                if (serving(num).load(std::memory_order::acquire) != num || !m_next->compare_exchange_strong(num, num + 1, mem_order, std::memory_order::relaxed))
+                { return false; }
+                own(num);
+                get_stat().record(false, typename stat_type::time_point{ });
+                return true;
+            }
+
+            void lock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                const value_type num = m_next->fetch_add(1, std::memory_order::relaxed);
+                atomic_type& target = serving(num);
+                const std::memory_order load_order = ticket_detail::acquire_order(mem_order);
+                value_type now = target.load(load_order);
+                const bool contended = now != num;
+                const auto begin = contended ? stat_type::start() : typename stat_type::time_point{ };
+                for (size_t round { }; now != num; ++round)
+                {
+                    // oversubscribed : the next holder may be descheduled, give the core away.
+                    if (round >= stamps::basis::spin_loop_val)
+                    { wait<tags::wait::yield>(); }
+                    // the slot hold the last served ticket of this residue, so the served ticket is in [now, now + Partition).
+                    // take the nearest one : num - now is a multiple of Partition.
+                    const size_t distance = static_cast<size_t>(num - now) - (Partition - 1);
+                    for (size_t count { }; count < distance * stamps::basis::ticket_backoff_val; ++count)
+                    { wait<tags::wait::pause>(); }
+                    now = target.load(load_order);
+                }
+                own(num);
+                get_stat().record(contended, begin);
+            }
+
+            void unlock(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                const value_type next = m_hold + 1;
+                get_owner().store(thread_id_t{ }, std::memory_order::relaxed);
+                serving(next).store(next, ticket_detail::release_order(mem_order));
+            }
+
+            bool is_own(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            { return get_owner().load(mem_order) == stamps::this_thread::id_v; }
+
+            // number of threads holding or waiting.
+            size_t queue_size(std::memory_order mem_order = std::memory_order::seq_cst) noexcept
+            {
+                // the latest served ticket is the slot value closest to next.
+                const value_type next = m_next->load(mem_order);
+                value_type ret = std::numeric_limits<value_type>::max();
+                for (auto& elem : m_serving)
+                { ret = std::min(ret, static_cast<value_type>(next - elem->load(mem_order))); }
+                return static_cast<size_t>(ret);
+            }
+
+            ticket_stat stat() noexcept { return get_stat().get(); }
+            void reset_stat() noexcept { get_stat().reset(); }
+    };
 } // namespace sia
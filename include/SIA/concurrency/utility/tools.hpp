@@ -5,6 +5,7 @@
 
 #include <thread>
 #include <functional>
+#include <atomic>
 
 // #include "SIA/concurrency/internals/define.hpp"
 
@@ -12,12 +13,15 @@
 #include "SIA/utility/recorder.hpp"
 #include "SIA/utility/types/function_pointer.hpp"
 
+#if defined(SIA_ARCH_X64) || defined(SIA_ARCH_X32)
+    #include <immintrin.h>
+#endif
 
 namespace sia
 {
     namespace tags
     {
-        enum class wait { busy, yield, sleep_for, sleep_until };
+        enum class wait { busy, yield, sleep_for, sleep_until, pause };
         enum class loop { busy, repeat_n, repeat_for, repeat_until };
     } // namespace tags
 
@@ -27,17 +31,32 @@ namespace sia
         {
             constexpr const default_time_rep_t empty_loop_val = 0;
             constexpr const default_time_rep_t empty_wait_val = 0;
+            constexpr const size_t spin_loop_val = 128;
         } // namespace tools
     } // namespace stamps
     
 
+    // spin-wait hint. let the sibling hyper-thread run and save power while polling.
+    inline void cpu_relax() noexcept
+    {
+        #if defined(SIA_ARCH_X64) || defined(SIA_ARCH_X32)
+            _mm_pause();
+        #elif defined(_MSC_VER) && defined(_M_ARM64)
+            __yield();
+        #elif defined(__aarch64__) || defined(__arm__)
+            __asm__ __volatile__("yield");
+        #else
+            std::atomic_signal_fence(std::memory_order::seq_cst);
+        #endif
+    }
+
     namespace tools_detail
     {
         template <tags::wait Tag, typename TimeType = default_time_rep_t>
         // consteval bool is_wait_nothrow(TimeType time = stamps::basis::empty_wait_val) noexcept
         consteval bool is_wait_nothrow(TimeType time = TimeType{ }) noexcept
         {
-            if constexpr (Tag == tags::wait::busy)
+            if constexpr (Tag == tags::wait::busy || Tag == tags::wait::pause)
             { return true; }
             else if constexpr (Tag == tags::wait::yield)
             { return noexcept(std::this_thread::yield()); }
@@ -61,6 +80,8 @@ namespace sia
         { std::this_thread::sleep_for(time); }
         else if constexpr (Tag == tags::wait::sleep_until)
         { std::this_thread::sleep_until(time); }
+        else if constexpr (Tag == tags::wait::pause)
+        { cpu_relax(); }
         else
         { }
     }
@@ -163,6 +184,20 @@ namespace sia
         { return false; }
     }
 
+    // spin while target == old, then park on the atomic wait word.
+    template <tags::wait WaitTag = tags::wait::busy, typename AtomicType, typename ValueType>
+    constexpr void spin_park(AtomicType& target, ValueType old, std::memory_order mem_order = std::memory_order::seq_cst, size_t spin_num = stamps::basis::spin_loop_val)
+        noexcept(tools_detail::is_wait_nothrow<WaitTag>())
+    {
+        for (size_t count { }; count < spin_num; ++count)
+        {
+            if (target.load(mem_order) != old)
+            { return; }
+            wait<WaitTag>();
+        }
+        target.wait(old, mem_order);
+    }
+
     template <typename Func>
     constexpr bool while_expression_exchange_weak(Func op, auto&& atomic, auto&& expect, auto desire, std::memory_order success_order, std::memory_order failure_order)
         noexcept(noexcept(op(expect, desire)))
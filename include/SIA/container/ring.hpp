@@ -166,11 +166,23 @@ namespace sia
                 { emplace_back(elem); }
             }
 
-            constexpr ring(ring&& arg, const allocator_type& alloc = allocator_type{ }) noexcept(std::is_nothrow_constructible_v<allocator_type, allocator_type&&>)
+            // with allocators that may differ (storage owned by the allocator), elements are moved one by one.
+            constexpr ring(ring&& arg, const allocator_type& alloc = allocator_type{ })
+                noexcept(std::is_nothrow_constructible_v<allocator_type, allocator_type&&> && std::allocator_traits<allocator_type>::is_always_equal::value)
                 : m_compair(splits::one_v, alloc)
             {
                 composition_t& comp = get_composition();
                 composition_t& target_comp = arg.get_composition();
+                if constexpr (!std::allocator_traits<allocator_type>::is_always_equal::value)
+                {
+                    if (!(get_allocator() == arg.get_allocator()))
+                    {
+                        comp.m_data = std::allocator_traits<allocator_type>::allocate(get_allocator(), capacity());
+                        for (auto& elem : arg)
+                        { emplace_back(std::move(elem)); }
+                        return;
+                    }
+                }
                 comp.m_data = target_comp.m_data;
                 target_comp.m_data = nullptr;
                 comp.m_begin = target_comp.m_begin;
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+
+namespace sia
+{
+    using tick_t = std::uint64_t;
+
+    struct timer_hook
+    {
+        timer_hook* m_prev = nullptr;
+        timer_hook* m_next = nullptr;
+        tick_t m_expire = 0;
+
+        constexpr bool is_linked() const noexcept { return m_next != nullptr; }
+    };
+
+    namespace timer_wheel_detail
+    {
+        // circular list with sentinel head.
+        struct slot
+        {
+            timer_hook m_head;
+
+            constexpr slot() noexcept { m_head.m_prev = m_head.m_next = &m_head; }
+            slot(const slot&) = delete;
+            slot& operator=(const slot&) = delete;
+
+            constexpr bool is_empty() const noexcept { return m_head.m_next == &m_head; }
+
+            constexpr void push_back(timer_hook& arg) noexcept
+            {
+                arg.m_prev = m_head.m_prev;
+                arg.m_next = &m_head;
+                m_head.m_prev->m_next = &arg;
+                m_head.m_prev = &arg;
+            }
+
+            static constexpr void unlink(timer_hook& arg) noexcept
+            {
+                arg.m_prev->m_next = arg.m_next;
+                arg.m_next->m_prev = arg.m_prev;
+                arg.m_prev = arg.m_next = nullptr;
+            }
+
+            // move every element to out (out must be empty).
+            constexpr void splice_to(slot& out) noexcept
+            {
+                if (is_empty()) { return; }
+                out.m_head.m_next = m_head.m_next;
+                out.m_head.m_prev = m_head.m_prev;
+                out.m_head.m_next->m_prev = &out.m_head;
+                out.m_head.m_prev->m_next = &out.m_head;
+                m_head.m_prev = m_head.m_next = &m_head;
+            }
+
+            constexpr timer_hook* front() noexcept { return is_empty() ? nullptr : m_head.m_next; }
+        };
+    } // namespace timer_wheel_detail
+
+    // cross-thread timer command, for feeding the wheel through concurrency::ring.
+    template <typename T>
+    struct timer_request
+    {
+        T* m_timer;
+        tick_t m_expire;
+        bool m_cancel;
+    };
+
+    // hierarchical hashed timer wheel. Level wheels of 2^SlotBits slots, level l tick every 2^(SlotBits * l) ticks.
+    // schedule / cancel are O(1) list operations on intrusive nodes (T derive from timer_hook), no allocation.
+    // advance expire one slot per tick in a batch and cascade upper levels when a lower wheel wrap.
+    // not thread safe. other threads feed it through pull(ring).
+    template <typename T = timer_hook, size_t SlotBits = 8, size_t Level = 4>
+        requires (std::is_base_of_v<timer_hook, T> && (SlotBits > 0) && (Level > 0) && (SlotBits * Level < 64))
+    struct timer_wheel
+    {
+        private:
+            using slot_type = timer_wheel_detail::slot;
+
+            static constexpr size_t slot_num() noexcept { return size_t{1} << SlotBits; }
+            static constexpr tick_t slot_mask() noexcept { return slot_num() - 1; }
+            static constexpr tick_t level_span(size_t level) noexcept { return tick_t{1} << (SlotBits * level); }
+
+            slot_type m_slot[Level][slot_num()];
+            tick_t m_now;
+            size_t m_size;
+
+            constexpr void place(timer_hook& arg) noexcept
+            {
+                const tick_t delta = arg.m_expire - m_now;
+                for (size_t level { }; level < Level; ++level)
+                {
+                    if (delta < level_span(level + 1))
+                    {
+                        m_slot[level][(arg.m_expire >> (SlotBits * level)) & slot_mask()].push_back(arg);
+                        return;
+                    }
+                }
+                // beyond the range. park in the farthest slot, it is placed again when cascaded.
+                const tick_t farthest = m_now + level_span(Level) - 1;
+                m_slot[Level - 1][(farthest >> (SlotBits * (Level - 1))) & slot_mask()].push_back(arg);
+            }
+
+            constexpr void cascade(size_t level) noexcept
+            {
+                slot_type tmp { };
+                m_slot[level][(m_now >> (SlotBits * level)) & slot_mask()].splice_to(tmp);
+                while (timer_hook* at = tmp.front())
+                {
+                    slot_type::unlink(*at);
+                    place(*at);
+                }
+            }
+
+            template <typename Func>
+            constexpr size_t tick(Func& func)
+            {
+                ++m_now;
+                for (size_t level = Level - 1; level > 0; --level)
+                {
+                    if ((m_now & (level_span(level) - 1)) == 0)
+                    { cascade(level); }
+                }
+                slot_type expired { };
+                m_slot[0][m_now & slot_mask()].splice_to(expired);
+                size_t ret { };
+                while (timer_hook* at = expired.front())
+                {
+                    slot_type::unlink(*at);
+                    --m_size;
+                    ++ret;
+                    func(static_cast<T&>(*at));
+                }
+                return ret;
+            }
+
+        public:
+            constexpr timer_wheel(tick_t now = 0) noexcept
+                : m_slot(), m_now(now), m_size(0)
+            { }
+
+            timer_wheel(const timer_wheel&) = delete;
+            timer_wheel(timer_wheel&&) = delete;
+            timer_wheel& operator=(const timer_wheel&) = delete;
+            timer_wheel& operator=(timer_wheel&&) = delete;
+
+            static constexpr tick_t range() noexcept { return level_span(Level); }
+
+            constexpr tick_t now() const noexcept { return m_now; }
+            constexpr size_t size() const noexcept { return m_size; }
+            constexpr bool is_empty() const noexcept { return m_size == 0; }
+
+            // expire at absolute tick. a tick not after now expire on the next tick.
+            constexpr void schedule(T& timer, tick_t expire) noexcept
+            {
+                timer_hook& target = timer;
+                if (target.is_linked()) { slot_type::unlink(target); --m_size; }
+                target.m_expire = expire > m_now ? expire : m_now + 1;
+                place(target);
+                ++m_size;
+            }
+
+            constexpr void schedule_after(T& timer, tick_t delay) noexcept
+            { schedule(timer, m_now + delay); }
+
+            // false when the timer is not scheduled.
+            constexpr bool cancel(T& timer) noexcept
+            {
+                timer_hook& target = timer;
+                if (!target.is_linked())
+                { return false; }
+                slot_type::unlink(target);
+                --m_size;
+                return true;
+            }
+
+            // run ticks up to target, func(T&) for each expired timer. func may schedule again.
+            // return the number of expired timers.
+            template <typename Func>
+                requires (std::is_invocable_v<Func, T&>)
+            constexpr size_t advance(tick_t target, Func&& func)
+            {
+                size_t ret { };
+                while (m_now < target)
+                {
+                    if (m_size == 0)
+                    {
+                        m_now = target;
+                        break;
+                    }
+                    ret += tick(func);
+                }
+                return ret;
+            }
+
+            // apply cross-thread requests from a ring of timer_request<T>. return the number applied.
+            template <typename Ring>
+            constexpr size_t pull(Ring& ring)
+            {
+                size_t ret { };
+                timer_request<T> req { };
+                while (ring.try_extract_front(req))
+                {
+                    if (req.m_cancel) { cancel(*req.m_timer); }
+                    else { schedule(*req.m_timer, req.m_expire); }
+                    ++ret;
+                }
+                return ret;
+            }
+    };
+} // namespace sia
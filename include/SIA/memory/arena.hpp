@@ -0,0 +1,166 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/memory/resource.hpp"
+
+namespace sia
+{
+    namespace arena_detail
+    {
+        constexpr size_t max_align() noexcept { return alignof(std::max_align_t); }
+
+        // block header, data follow it.
+        struct block
+        {
+            block* m_next;
+            size_t m_size;
+
+            static constexpr size_t header_size() noexcept { return (sizeof(block) + max_align() - 1) / max_align() * max_align(); }
+            byte_t* data() noexcept { return reinterpret_cast<byte_t*>(this) + header_size(); }
+        };
+
+        template <size_t InlineSize>
+        struct inline_buffer
+        {
+            alignas(max_align()) byte_t m_data[InlineSize];
+
+            constexpr byte_t* data() noexcept { return m_data; }
+            static constexpr size_t size() noexcept { return InlineSize; }
+        };
+
+        template <>
+        struct inline_buffer<0>
+        {
+            constexpr byte_t* data() noexcept { return nullptr; }
+            static constexpr size_t size() noexcept { return 0; }
+        };
+    } // namespace arena_detail
+
+    // bump-pointer arena over chained blocks. deallocate is a no-op, memory come back all at once with reset() or release().
+    // the InlineSize buffer (inside the arena) is used first, then blocks from the upstream resource, each twice the last.
+    // reset() is O(1) : blocks are kept and reused in order, so a steady request load stop touching the upstream.
+    // a std::pmr::memory_resource (final, calls through the concrete type are not virtual).
+    // not thread safe.
+    template <size_t InlineSize = 0>
+    struct monotonic_arena final : public std::pmr::memory_resource
+    {
+        private:
+            using block = arena_detail::block;
+
+            arena_detail::inline_buffer<InlineSize> m_inline;
+            std::pmr::memory_resource* m_upstream;
+            block* m_head;  // first block of the chain
+            block* m_block; // block in use, nullptr while the inline buffer is in use
+            byte_t* m_cur;
+            byte_t* m_end;
+            size_t m_next_size;
+
+            void* bump(size_t bytes, size_t align) noexcept
+            {
+                void* at = m_cur;
+                size_t space = static_cast<size_t>(m_end - m_cur);
+                if (m_cur != nullptr && std::align(align, bytes, at, space) != nullptr)
+                {
+                    m_cur = static_cast<byte_t*>(at) + bytes;
+                    return at;
+                }
+                return nullptr;
+            }
+
+            // move to the next kept block that fit, or chain a new one after the current block.
+            void* grow(size_t bytes, size_t align)
+            {
+                const size_t need = bytes + (align > arena_detail::max_align() ? align : 0);
+                block* next = m_block == nullptr ? m_head : m_block->m_next;
+                while (next != nullptr && next->m_size < need)
+                { next = next->m_next; }
+                if (next == nullptr)
+                {
+                    const size_t size = std::max(m_next_size, need);
+                    next = static_cast<block*>(m_upstream->allocate(block::header_size() + size, arena_detail::max_align()));
+                    next->m_size = size;
+                    if (m_block == nullptr)
+                    {
+                        next->m_next = m_head;
+                        m_head = next;
+                    }
+                    else
+                    {
+                        next->m_next = m_block->m_next;
+                        m_block->m_next = next;
+                    }
+                    m_next_size *= 2;
+                }
+                m_block = next;
+                m_cur = next->data();
+                m_end = m_cur + next->m_size;
+                return bump(bytes, align);
+            }
+
+            void* do_allocate(size_t bytes, size_t align) override
+            {
+                bytes = bytes == 0 ? 1 : bytes;
+                void* ret = bump(bytes, align);
+                return ret != nullptr ? ret : grow(bytes, align);
+            }
+
+            void do_deallocate(void*, size_t, size_t) override { }
+
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            { return this == &arg; }
+
+        public:
+            monotonic_arena(size_t block_size = 4096, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+                : m_inline(), m_upstream(upstream), m_head(nullptr), m_block(nullptr),
+                  m_cur(m_inline.data()), m_end(m_inline.data() + InlineSize), m_next_size(block_size == 0 ? 1 : block_size)
+            { }
+
+            monotonic_arena(const monotonic_arena&) = delete;
+            monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+            ~monotonic_arena() noexcept override
+            { release(); }
+
+            std::pmr::memory_resource* upstream() const noexcept { return m_upstream; }
+
+            // every allocation is invalidated, blocks are kept.
+            void reset() noexcept
+            {
+                m_block = nullptr;
+                m_cur = m_inline.data();
+                m_end = m_inline.data() + InlineSize;
+            }
+
+            // every allocation is invalidated, blocks go back to the upstream.
+            void release() noexcept
+            {
+                for (block* at = m_head; at != nullptr;)
+                {
+                    block* next = at->m_next;
+                    m_upstream->deallocate(at, block::header_size() + at->m_size, arena_detail::max_align());
+                    at = next;
+                }
+                m_head = nullptr;
+                reset();
+            }
+
+            // bytes held from the upstream.
+            size_t capacity() const noexcept
+            {
+                size_t ret { };
+                for (block* at = m_head; at != nullptr; at = at->m_next)
+                { ret += at->m_size; }
+                return ret + InlineSize;
+            }
+    };
+
+    template <typename T, size_t InlineSize = 0>
+    using arena_allocator = resource_allocator<T, monotonic_arena<InlineSize>>;
+} // namespace sia
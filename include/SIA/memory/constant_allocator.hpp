@@ -1,13 +1,29 @@
 #pragma once
 
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+
 namespace sia
 {
     namespace constant_allocator_detail
     {
         template <auto E> constexpr auto make_data = [] () constexpr noexcept -> decltype(E) { return E; };
         template <auto E> using make_data_t = decltype(make_data<E>);
+
+        // one buffer per (T, Capacity, Tag, Align), zero initialized so it lands in .bss.
+        // s_used is set while the block is handed out.
+        template <typename T, size_t Capacity, typename Tag, size_t Align>
+        struct static_storage
+        {
+            alignas(Align) static inline byte_t s_data[sizeof(T) * Capacity] { };
+            static inline std::atomic<bool> s_used { };
+        };
     } // namespace constant_allocator_detail
-    
+
     template <auto E>
     struct constant_allocator : public constant_allocator_detail::make_data_t<E>
     {
@@ -17,4 +33,85 @@ namespace sia
         constexpr auto allocate(this auto&& self) noexcept { return self.base_t::operator()(); }
         constexpr auto callable(this auto&& self) noexcept { return static_cast<base_t>(self); }
     };
+
+    // storage inside the allocator, so a container holding it (lane, ring) live entirely where it is declared.
+    // one live block of up to Capacity elements : for containers that allocate once, not for growing ones.
+    // a copy has its own (empty) storage and never compare equal, so containers do not propagate it.
+    template <typename T, size_t Capacity, size_t Align = alignof(T)>
+        requires ((Capacity > 0) && (Align >= alignof(T)) && ((Align & (Align - 1)) == 0))
+    struct inplace_allocator
+    {
+    private:
+        alignas(Align) byte_t m_storage[sizeof(T) * Capacity];
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+        using is_always_equal = std::false_type;
+
+        template <typename Ty>
+        struct rebind { using other = inplace_allocator<Ty, Capacity, std::max(Align, alignof(Ty))>; };
+
+        constexpr inplace_allocator() noexcept { }
+        constexpr inplace_allocator(const inplace_allocator&) noexcept { }
+        template <typename Ty, size_t Al>
+        constexpr inplace_allocator(const inplace_allocator<Ty, Capacity, Al>&) noexcept { }
+        constexpr inplace_allocator& operator=(const inplace_allocator&) noexcept { return *this; }
+
+        constexpr inplace_allocator select_on_container_copy_construction() const noexcept { return inplace_allocator{ }; }
+
+        static constexpr size_t capacity() noexcept { return Capacity; }
+
+        [[nodiscard]] T* allocate(size_t num)
+        {
+            if (num > Capacity)
+            { throw std::bad_alloc{ }; }
+            return reinterpret_cast<T*>(m_storage);
+        }
+
+        constexpr void deallocate(T*, size_t) noexcept { }
+
+        friend constexpr bool operator==(const inplace_allocator& lhs, const inplace_allocator& rhs) noexcept { return &lhs == &rhs; }
+    };
+
+    // storage in a static buffer (.bss) shared by every static_allocator of the same (T, Capacity, Tag, Align).
+    // stateless and always equal, containers holding it can be moved freely.
+    // one live block per buffer (std::bad_alloc on a second one) : each container name its own Tag.
+    template <typename T, size_t Capacity, typename Tag, size_t Align = alignof(T)>
+        requires ((Capacity > 0) && (Align >= alignof(T)) && ((Align & (Align - 1)) == 0))
+    struct static_allocator
+    {
+    private:
+        using storage_type = constant_allocator_detail::static_storage<T, Capacity, Tag, Align>;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template <typename Ty>
+        struct rebind { using other = static_allocator<Ty, Capacity, Tag, std::max(Align, alignof(Ty))>; };
+
+        constexpr static_allocator() noexcept = default;
+        template <typename Ty, size_t Al>
+        constexpr static_allocator(const static_allocator<Ty, Capacity, Tag, Al>&) noexcept { }
+
+        static constexpr size_t capacity() noexcept { return Capacity; }
+
+        [[nodiscard]] T* allocate(size_t num)
+        {
+            if (num > Capacity || storage_type::s_used.exchange(true, std::memory_order::acquire))
+            { throw std::bad_alloc{ }; }
+            return reinterpret_cast<T*>(storage_type::s_data);
+        }
+
+        void deallocate(T*, size_t) noexcept { storage_type::s_used.store(false, std::memory_order::release); }
+
+        template <typename Ty, size_t Al>
+        friend constexpr bool operator==(const static_allocator&, const static_allocator<Ty, Capacity, Tag, Al>&) noexcept { return true; }
+    };
 }   //  namespace sia
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/internals/define.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/memory/resource.hpp"
+
+#if defined(SIA_OS_LINUX)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace sia
+{
+    namespace huge_page_policy
+    {
+        // automatic : MAP_HUGETLB, then madvise(MADV_HUGEPAGE) on failure.
+        // hugetlb : MAP_HUGETLB only, std::bad_alloc when the pool is empty.
+        // transparent : madvise(MADV_HUGEPAGE) only.
+        // none : normal pages, huge page alignment kept.
+        enum class policy { automatic, hugetlb, transparent, none };
+    } // namespace huge_page_policy
+
+    namespace huge_page_detail
+    {
+        constexpr size_t default_page_size() noexcept { return size_t{1} << 21; }
+
+        constexpr size_t round_up(size_t value, size_t unit) noexcept
+        { return (value + unit - 1) / unit * unit; }
+
+        inline size_t system_page_size() noexcept
+        {
+            #if defined(SIA_OS_LINUX)
+                static const size_t ret = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+                return ret;
+            #else
+                return 4096;
+            #endif
+        }
+
+        // bytes mapped by each path since construction.
+        struct stat
+        {
+            std::atomic<size_t> m_hugetlb { };
+            std::atomic<size_t> m_transparent { };
+            std::atomic<size_t> m_normal { };
+        };
+    } // namespace huge_page_detail
+
+    // memory resource over anonymous mappings backed by huge pages, for large rings and pools where TLB misses dominate.
+    // requests of at least one huge page are rounded up to whole huge pages and aligned to PageSize (or to their alignment when larger),
+    // smaller requests take normal pages. each allocate is one mapping, deallocate unmap it.
+    // populate pre-fault the pages at allocate (MAP_POPULATE / MADV_POPULATE_WRITE), so the first scan do not pay the page faults.
+    // thread safe (the kernel serialize the mappings), but each call is a system call : allocate big blocks, not objects.
+    // other systems than linux get aligned ::operator new.
+    struct huge_page_resource final : public std::pmr::memory_resource
+    {
+        private:
+            using policy_type = huge_page_policy::policy;
+
+            size_t m_page_size;
+            policy_type m_policy;
+            bool m_populate;
+            huge_page_detail::stat m_stat;
+
+            size_t granule(size_t bytes) const noexcept
+            { return bytes >= m_page_size ? m_page_size : huge_page_detail::system_page_size(); }
+
+            #if defined(SIA_OS_LINUX)
+                void* map_hugetlb(size_t size) noexcept
+                {
+                    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (m_populate ? MAP_POPULATE : 0);
+                    #if defined(MAP_HUGE_SHIFT)
+                        flags |= static_cast<int>(std::countr_zero(m_page_size)) << MAP_HUGE_SHIFT;
+                    #endif
+                    void* ret = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+                    return ret == MAP_FAILED ? nullptr : ret;
+                }
+
+                // over-map and trim, so the block start on an align boundary (the kernel only back aligned ranges with huge pages).
+                void* map_aligned(size_t size, size_t align, bool transparent) noexcept
+                {
+                    const size_t extra = align > huge_page_detail::system_page_size() ? align : 0;
+                    void* raw = ::mmap(nullptr, size + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (raw == MAP_FAILED)
+                    { return nullptr; }
+                    byte_t* base = static_cast<byte_t*>(raw);
+                    byte_t* ret = reinterpret_cast<byte_t*>(huge_page_detail::round_up(reinterpret_cast<std::uintptr_t>(base), std::max(align, size_t{1})));
+                    if (ret != base)
+                    { ::munmap(base, static_cast<size_t>(ret - base)); }
+                    if (byte_t* tail = ret + size; tail != base + size + extra)
+                    { ::munmap(tail, static_cast<size_t>(base + size + extra - tail)); }
+                    #if defined(MADV_HUGEPAGE)
+                        if (transparent) { ::madvise(ret, size, MADV_HUGEPAGE); }
+                    #endif
+                    if (m_populate)
+                    { prefault(ret, size); }
+                    return ret;
+                }
+
+                static void prefault(byte_t* ptr, size_t size) noexcept
+                {
+                    #if defined(MADV_POPULATE_WRITE)
+                        if (::madvise(ptr, size, MADV_POPULATE_WRITE) == 0)
+                        { return; }
+                    #endif
+                    const size_t step = huge_page_detail::system_page_size();
+                    for (size_t offset { }; offset < size; offset += step)
+                    { static_cast<volatile byte_t*>(ptr)[offset] = byte_t{ }; }
+                }
+            #endif
+
+            void* do_allocate(size_t bytes, size_t align) override
+            {
+                const size_t size = huge_page_detail::round_up(bytes == 0 ? 1 : bytes, granule(bytes));
+                #if defined(SIA_OS_LINUX)
+                    const bool huge = bytes >= m_page_size && m_policy != policy_type::none;
+                    if (huge && (m_policy == policy_type::automatic || m_policy == policy_type::hugetlb) && align <= m_page_size)
+                    {
+                        if (void* ret = map_hugetlb(size); ret != nullptr)
+                        {
+                            m_stat.m_hugetlb.fetch_add(size, std::memory_order::relaxed);
+                            return ret;
+                        }
+                    }
+                    if (huge && m_policy == policy_type::hugetlb)
+                    { throw std::bad_alloc{ }; }
+                    const size_t page_align = bytes >= m_page_size ? m_page_size : huge_page_detail::system_page_size();
+                    void* ret = map_aligned(size, std::max(align, page_align), huge);
+                    if (ret == nullptr)
+                    { throw std::bad_alloc{ }; }
+                    (huge ? m_stat.m_transparent : m_stat.m_normal).fetch_add(size, std::memory_order::relaxed);
+                    return ret;
+                #else
+                    m_stat.m_normal.fetch_add(size, std::memory_order::relaxed);
+                    return ::operator new(size, std::align_val_t{std::max(align, granule(bytes))});
+                #endif
+            }
+
+            void do_deallocate(void* ptr, size_t bytes, [[maybe_unused]] size_t align) override
+            {
+                const size_t size = huge_page_detail::round_up(bytes == 0 ? 1 : bytes, granule(bytes));
+                #if defined(SIA_OS_LINUX)
+                    ::munmap(ptr, size);
+                #else
+                    ::operator delete(ptr, size, std::align_val_t{std::max(align, granule(bytes))});
+                #endif
+            }
+
+            // blocks only depend on the page size, any resource with the same one can free them.
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            {
+                const huge_page_resource* other = dynamic_cast<const huge_page_resource*>(&arg);
+                return other != nullptr && other->m_page_size == m_page_size;
+            }
+
+        public:
+            // page_size must be a huge page size of the system (2 MiB or 1 GiB on x86-64).
+            huge_page_resource(bool populate = false, policy_type policy = policy_type::automatic, size_t page_size = huge_page_detail::default_page_size()) noexcept
+                : m_page_size(page_size), m_policy(policy), m_populate(populate), m_stat()
+            {
+                assertm(std::has_single_bit(page_size), "Error : huge page size must be a power of two.");
+            }
+
+            huge_page_resource(const huge_page_resource&) = delete;
+            huge_page_resource& operator=(const huge_page_resource&) = delete;
+
+            size_t page_size() const noexcept { return m_page_size; }
+            policy_type policy() const noexcept { return m_policy; }
+            bool populate() const noexcept { return m_populate; }
+
+            // bytes mapped through MAP_HUGETLB / madvise(MADV_HUGEPAGE) / normal pages since construction.
+            size_t hugetlb_bytes() const noexcept { return m_stat.m_hugetlb.load(std::memory_order::relaxed); }
+            size_t transparent_bytes() const noexcept { return m_stat.m_transparent.load(std::memory_order::relaxed); }
+            size_t normal_bytes() const noexcept { return m_stat.m_normal.load(std::memory_order::relaxed); }
+    };
+
+    template <typename T>
+    using huge_page_allocator = resource_allocator<T, huge_page_resource>;
+} // namespace sia
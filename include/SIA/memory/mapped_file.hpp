@@ -0,0 +1,310 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <system_error>
+#include <type_traits>
+#include <memory_resource>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+#include "SIA/memory/offset_ptr.hpp"
+
+namespace sia
+{
+    namespace mapped_file_detail
+    {
+        constexpr std::uint64_t magic() noexcept { return 0x5349414d41505046ULL; } // "SIAMAPPF"
+        constexpr std::uint64_t version() noexcept { return 1; }
+        constexpr size_t class_num() noexcept { return 64; }
+        constexpr size_t root_num() noexcept { return 16; }
+        constexpr size_t min_block() noexcept { return 16; }
+        constexpr size_t max_align() noexcept { return 4096; }
+
+        // power of two classes from 16 bytes. blocks of a class are aligned to min(class size, max_align()).
+        constexpr size_t class_of(size_t bytes, size_t align) noexcept
+        { return static_cast<size_t>(std::bit_width(std::max({bytes, align, min_block()}) - 1)); }
+
+        // first bytes of the file. every link is an offset from the file start (0 is none).
+        struct header
+        {
+            std::uint64_t m_magic;
+            std::uint64_t m_version;
+            std::uintptr_t m_base;      // address of the mapping that made the file
+            size_t m_capacity;
+            size_t m_top;
+            size_t m_free[class_num()];
+            size_t m_root[root_num()];
+            size_t m_root_size[root_num()];
+            sia::mutex m_lock;
+
+            byte_t* base() noexcept { return reinterpret_cast<byte_t*>(this); }
+
+            static constexpr size_t header_size() noexcept { return (sizeof(header) + max_align() - 1) / max_align() * max_align(); }
+
+            void init(size_t capacity) noexcept
+            {
+                m_magic = magic();
+                m_version = version();
+                m_base = reinterpret_cast<std::uintptr_t>(this);
+                m_capacity = capacity;
+                m_top = header_size();
+                std::fill(std::begin(m_free), std::end(m_free), size_t{ });
+                std::fill(std::begin(m_root), std::end(m_root), size_t{ });
+                std::fill(std::begin(m_root_size), std::end(m_root_size), size_t{ });
+                std::construct_at(&m_lock);
+            }
+
+            bool is_valid(size_t file_size) const noexcept
+            { return m_magic == magic() && m_version == version() && m_capacity == file_size; }
+
+            void* allocate(size_t bytes, size_t align)
+            {
+                const size_t idx = class_of(bytes, align);
+                if (align > max_align() || idx >= class_num())
+                { throw std::bad_alloc{ }; }
+                quota guard {m_lock};
+                if (size_t at = m_free[idx]; at != 0)
+                {
+                    m_free[idx] = *reinterpret_cast<size_t*>(base() + at);
+                    return base() + at;
+                }
+                const size_t size = size_t{1} << idx;
+                const size_t unit = std::min(size, max_align());
+                const size_t at = (m_top + unit - 1) / unit * unit;
+                if (at > m_capacity || size > m_capacity - at)
+                { throw std::bad_alloc{ }; }
+                m_top = at + size;
+                return base() + at;
+            }
+
+            void deallocate(void* ptr, size_t bytes, size_t align) noexcept
+            {
+                const size_t idx = class_of(bytes, align);
+                const size_t at = static_cast<size_t>(static_cast<byte_t*>(ptr) - base());
+                quota guard {m_lock};
+                *reinterpret_cast<size_t*>(ptr) = m_free[idx];
+                m_free[idx] = at;
+            }
+        };
+    } // namespace mapped_file_detail
+
+    // memory resource carving allocations out of a memory-mapped file, for containers that survive restarts without serialization.
+    // allocations are power of two blocks recycled through per-size free lists kept in the file, so a reopened file keep its free blocks.
+    // a reopened file is mapped at the address recorded at creation, so raw pointers stored in it (sia::lane, sia::ring ...) stay valid.
+    // when that address is taken, the file is mapped elsewhere and is_relocated() is true : only offset_ptr / offsets stay valid.
+    // checkpoint() flush the used part with msync. data written after the last checkpoint may be lost on a crash (not on a clean exit).
+    // the lock in the file assume one process use the file at a time.
+    struct mapped_file_resource final : public std::pmr::memory_resource
+    {
+        private:
+            using header_type = mapped_file_detail::header;
+
+            int m_fd;
+            header_type* m_header;
+            size_t m_capacity;
+            bool m_relocated;
+            bool m_created;
+
+            static void fail(const char* what)
+            { throw std::system_error{errno, std::generic_category(), what}; }
+
+            static void* map(size_t capacity, int fd, void* hint)
+            {
+                int flags = MAP_SHARED;
+                #if defined(MAP_FIXED_NOREPLACE)
+                    if (hint != nullptr) { flags |= MAP_FIXED_NOREPLACE; }
+                #endif
+                void* ret = ::mmap(hint, capacity, PROT_READ | PROT_WRITE, flags, fd, 0);
+                if (ret == MAP_FAILED && hint != nullptr)
+                { ret = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); }
+                if (ret == MAP_FAILED)
+                { fail("mapped_file_resource : mmap"); }
+                return ret;
+            }
+
+            void* do_allocate(size_t bytes, size_t align) override
+            { return m_header->allocate(bytes, align); }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t align) override
+            { m_header->deallocate(ptr, bytes, align); }
+
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            { return this == &arg; }
+
+        public:
+            // open path, or create it with capacity bytes when it does not exist (or is not a valid file of this resource and truncate is true).
+            // hint : address for a new file (nullptr let the kernel choose).
+            mapped_file_resource(const char* path, size_t capacity, void* hint = nullptr, bool truncate = false)
+                : m_fd(-1), m_header(nullptr), m_capacity(0), m_relocated(false), m_created(false)
+            {
+                m_fd = ::open(path, O_RDWR | O_CREAT, 0644);
+                if (m_fd < 0)
+                { fail("mapped_file_resource : open"); }
+                // the error is thrown (errno read) before the descriptor is closed.
+                try
+                {
+                    struct ::stat info { };
+                    if (::fstat(m_fd, &info) != 0)
+                    { fail("mapped_file_resource : fstat"); }
+
+                    header_type probe { };
+                    const size_t file_size = static_cast<size_t>(info.st_size);
+                    const bool valid = file_size >= header_type::header_size()
+                        && ::pread(m_fd, &probe, sizeof(header_type), 0) == static_cast<ssize_t>(sizeof(header_type)) && probe.is_valid(file_size);
+                    if (!valid && file_size != 0 && !truncate)
+                    {
+                        errno = EINVAL;
+                        fail("mapped_file_resource : not a mapped file");
+                    }
+                    if (valid)
+                    {
+                        m_capacity = file_size;
+                        m_header = static_cast<header_type*>(map(m_capacity, m_fd, reinterpret_cast<void*>(probe.m_base)));
+                        m_relocated = reinterpret_cast<std::uintptr_t>(m_header) != probe.m_base;
+                        // a lock held by a dead process is released.
+                        std::construct_at(&m_header->m_lock);
+                        return;
+                    }
+                    m_capacity = std::max(capacity, header_type::header_size());
+                    if (::ftruncate(m_fd, static_cast<off_t>(m_capacity)) != 0)
+                    { fail("mapped_file_resource : ftruncate"); }
+                    m_header = static_cast<header_type*>(map(m_capacity, m_fd, hint));
+                    m_header->init(m_capacity);
+                    m_created = true;
+                }
+                catch (...)
+                {
+                    ::close(m_fd);
+                    throw;
+                }
+            }
+
+            mapped_file_resource(const mapped_file_resource&) = delete;
+            mapped_file_resource& operator=(const mapped_file_resource&) = delete;
+
+            // unmapping write dirty pages back (asynchronously), objects in the file are not destroyed.
+            ~mapped_file_resource() noexcept override
+            {
+                ::munmap(m_header, m_capacity);
+                ::close(m_fd);
+            }
+
+            // flush the used part of the file. wait for the write when sync is true.
+            void checkpoint(bool sync = true)
+            {
+                if (::msync(m_header, m_header->m_top, sync ? MS_SYNC : MS_ASYNC) != 0)
+                { fail("mapped_file_resource : msync"); }
+            }
+
+            byte_t* base() const noexcept { return m_header->base(); }
+            size_t capacity() const noexcept { return m_capacity; }
+            size_t used() const noexcept { return m_header->m_top; }
+            bool is_created() const noexcept { return m_created; }
+            bool is_relocated() const noexcept { return m_relocated; }
+            mapped_file_detail::header& header() const noexcept { return *m_header; }
+
+            size_t to_offset(const void* ptr) const noexcept
+            { return ptr == nullptr ? 0 : static_cast<size_t>(static_cast<const byte_t*>(ptr) - base()); }
+
+            template <typename T>
+            T* from_offset(size_t offset) const noexcept
+            { return offset == 0 ? nullptr : reinterpret_cast<T*>(base() + offset); }
+
+            // the object in root slot idx, constructed from args in the file when the slot is empty.
+            template <typename T, typename... Tys>
+            T& root(size_t idx, Tys&&... args)
+            {
+                assertm(idx < mapped_file_detail::root_num(), "Error : root index out of range");
+                if (size_t at = m_header->m_root[idx]; at != 0)
+                {
+                    assertm(m_header->m_root_size[idx] == sizeof(T), "Error : root type mismatch");
+                    return *from_offset<T>(at);
+                }
+                void* storage = m_header->allocate(sizeof(T), alignof(T));
+                T* ret = nullptr;
+                try { ret = std::construct_at(static_cast<T*>(storage), std::forward<Tys>(args)...); }
+                catch (...) { m_header->deallocate(storage, sizeof(T), alignof(T)); throw; }
+                m_header->m_root_size[idx] = sizeof(T);
+                m_header->m_root[idx] = to_offset(ret);
+                return *ret;
+            }
+
+            bool has_root(size_t idx) const noexcept
+            { return m_header->m_root[idx] != 0; }
+
+            // destroy the root object and free its block.
+            template <typename T>
+            void erase_root(size_t idx)
+            {
+                T* target = from_offset<T>(m_header->m_root[idx]);
+                if (target == nullptr)
+                { return; }
+                std::destroy_at(target);
+                m_header->deallocate(target, sizeof(T), alignof(T));
+                m_header->m_root[idx] = 0;
+                m_header->m_root_size[idx] = 0;
+            }
+    };
+
+    // allocator over a mapped file. it point to the file header with an offset_ptr,
+    // so a container stored in the file keep a working allocator after a reopen.
+    template <typename T>
+    struct mapped_allocator
+    {
+            template <typename Ty>
+            friend struct mapped_allocator;
+        private:
+            offset_ptr<mapped_file_detail::header> m_header;
+
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = std::true_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+            using is_always_equal = std::false_type;
+
+            template <typename Ty>
+            struct rebind { using other = mapped_allocator<Ty>; };
+
+            mapped_allocator(mapped_file_resource& resource) noexcept
+                : m_header(&resource.header())
+            { }
+
+            mapped_allocator(const mapped_allocator& arg) noexcept = default;
+
+            template <typename Ty>
+            mapped_allocator(const mapped_allocator<Ty>& arg) noexcept
+                : m_header(arg.m_header)
+            { }
+
+            mapped_allocator& operator=(const mapped_allocator& arg) noexcept = default;
+
+            [[nodiscard]] T* allocate(size_t num)
+            {
+                if (num > static_cast<size_t>(-1) / sizeof(T))
+                { throw std::bad_array_new_length{ }; }
+                return static_cast<T*>(m_header->allocate(num * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T* ptr, size_t num) noexcept
+            { m_header->deallocate(ptr, num * sizeof(T), alignof(T)); }
+
+            template <typename Ty>
+            friend bool operator==(const mapped_allocator& lhs, const mapped_allocator<Ty>& rhs) noexcept
+            { return lhs.m_header.get() == rhs.m_header.get(); }
+    };
+} // namespace sia
@@ -0,0 +1,770 @@
+#pragma once
+
+#include <new>
+#include <tuple>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <cstring>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/recorder.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+
+namespace sia
+{
+    namespace memory_shelf_policy
+    {
+        // none    : deallocated memory first, then sequential memory.
+        // poor    : deallocated memory only.
+        // rich    : sequential memory only.
+        // thrifty : recycle() -> deallocated memory only -> recover().
+        enum class policy { none, poor, rich, thrifty };
+    } // namespace memory_shelf_policy
+
+    namespace memory_shelf_detail
+    {
+        // word range [m_pos, m_pos + m_size) of a page.
+        struct extent
+        {
+            size_t m_pos;
+            size_t m_size;
+        };
+
+        // two level size classes (tlsf) : first level = power of two, second level split it in 4.
+        constexpr size_t second_bits() noexcept { return 2; }
+        constexpr size_t second_num() noexcept { return size_t{1} << second_bits(); }
+
+        struct class_pos
+        {
+            size_t m_first;
+            size_t m_second;
+        };
+
+        // class holding an extent of words.
+        constexpr class_pos floor_class(size_t words) noexcept
+        {
+            const size_t raw = static_cast<size_t>(std::bit_width(words)) - 1;
+            if (raw < second_bits())
+            { return {0, words}; }
+            return {raw - second_bits() + 1, (words >> (raw - second_bits())) - second_num()};
+        }
+
+        // lowest class whose every extent can hold words.
+        constexpr class_pos ceil_class(size_t words) noexcept
+        {
+            const size_t raw = static_cast<size_t>(std::bit_width(words)) - 1;
+            return raw < second_bits() ? floor_class(words) : floor_class(words + (size_t{1} << (raw - second_bits())) - 1);
+        }
+
+        constexpr size_t first_num(size_t words) noexcept { return floor_class(words).m_first + 1; }
+
+        // header of a deallocated extent, written in its first bytes. every extent is at least one granule, so it always fit.
+        struct free_node
+        {
+            size_t m_size;
+            size_t m_next;  // word of the next extent of the list, npos() at the end
+        };
+
+        constexpr size_t npos() noexcept { return std::numeric_limits<size_t>::max(); }
+
+        // words of a granule : allocations, gaps and remainders are multiples of it.
+        constexpr size_t unit_words(size_t word_size) noexcept { return (sizeof(free_node) + word_size - 1) / word_size; }
+
+        // sequential information : words [m_top, WordNum) were never handed out (or were recovered).
+        // deallocated information : extents given back below m_top, listed by size class with bitmaps of non-empty classes.
+        // the lists are linked through the deallocated words themselves, so page information never allocate.
+        template <size_t FirstNum, size_t WordSize>
+        struct page_info
+        {
+            byte_t* m_memory = nullptr;
+            size_t m_top = 0;
+            size_t m_first_mask = 0;
+            size_t m_second_mask[FirstNum] { };
+            size_t m_free[FirstNum][second_num()];
+
+            constexpr page_info() noexcept
+            {
+                for (auto& row : m_free)
+                { std::fill(std::begin(row), std::end(row), npos()); }
+            }
+
+            // headers can sit at any word, copy them instead of casting.
+            free_node node(size_t pos) const noexcept
+            {
+                free_node ret;
+                std::memcpy(&ret, m_memory + pos * WordSize, sizeof(free_node));
+                return ret;
+            }
+
+            void set_node(size_t pos, free_node arg) noexcept
+            { std::memcpy(m_memory + pos * WordSize, &arg, sizeof(free_node)); }
+
+            size_t next_of(size_t pos) const noexcept { return node(pos).m_next; }
+
+            void link(size_t pos, size_t next) noexcept
+            { std::memcpy(m_memory + pos * WordSize + offsetof(free_node, m_next), &next, sizeof(size_t)); }
+
+            void push(extent arg) noexcept
+            {
+                const class_pos target = floor_class(arg.m_size);
+                size_t& head = m_free[target.m_first][target.m_second];
+                set_node(arg.m_pos, free_node{arg.m_size, head});
+                head = arg.m_pos;
+                m_second_mask[target.m_first] |= size_t{1} << target.m_second;
+                m_first_mask |= size_t{1} << target.m_first;
+            }
+
+            // unlink at from the list of target. prev is the extent before it, npos() when at is the head.
+            extent take(class_pos target, size_t prev, size_t at) noexcept
+            {
+                size_t& head = m_free[target.m_first][target.m_second];
+                const free_node cur = node(at);
+                if (prev == npos()) { head = cur.m_next; }
+                else { link(prev, cur.m_next); }
+                if (head == npos())
+                {
+                    m_second_mask[target.m_first] &= ~(size_t{1} << target.m_second);
+                    if (m_second_mask[target.m_first] == 0) { m_first_mask &= ~(size_t{1} << target.m_first); }
+                }
+                return extent{at, cur.m_size};
+            }
+
+            // first non-empty class at or above target. false when there is none.
+            constexpr bool find(class_pos& target) const noexcept
+            {
+                if (target.m_first >= FirstNum)
+                { return false; }
+                const size_t second = m_second_mask[target.m_first] & (~size_t{ } << target.m_second);
+                if (second != 0)
+                {
+                    target.m_second = static_cast<size_t>(std::countr_zero(second));
+                    return true;
+                }
+                const size_t first = target.m_first + 1 < FirstNum ? m_first_mask & (~size_t{ } << (target.m_first + 1)) : 0;
+                if (first == 0)
+                { return false; }
+                target.m_first = static_cast<size_t>(std::countr_zero(first));
+                target.m_second = static_cast<size_t>(std::countr_zero(m_second_mask[target.m_first]));
+                return true;
+            }
+
+            // merge two lists sorted by position.
+            size_t merge(size_t lhs, size_t rhs) noexcept
+            {
+                size_t head = npos();
+                size_t tail = npos();
+                while (lhs != npos() && rhs != npos())
+                {
+                    size_t& pick = lhs < rhs ? lhs : rhs;
+                    const size_t at = pick;
+                    pick = next_of(at);
+                    if (tail == npos()) { head = at; }
+                    else { link(tail, at); }
+                    tail = at;
+                }
+                const size_t rest = lhs != npos() ? lhs : rhs;
+                if (tail == npos())
+                { return rest; }
+                link(tail, rest);
+                return head;
+            }
+
+            // merge sort of a list by position, in place.
+            size_t sort(size_t head) noexcept
+            {
+                if (head == npos() || next_of(head) == npos())
+                { return head; }
+                size_t slow = head;
+                size_t fast = next_of(head);
+                while (fast != npos() && next_of(fast) != npos())
+                {
+                    slow = next_of(slow);
+                    fast = next_of(next_of(fast));
+                }
+                const size_t second = next_of(slow);
+                link(slow, npos());
+                return merge(sort(head), sort(second));
+            }
+
+            // move every deallocated extent out, as one list sorted by position.
+            size_t gather() noexcept
+            {
+                size_t ret = npos();
+                for (auto& row : m_free)
+                {
+                    for (size_t& head : row)
+                    {
+                        for (size_t at = head; at != npos();)
+                        {
+                            const size_t next = next_of(at);
+                            link(at, ret);
+                            ret = at;
+                            at = next;
+                        }
+                        head = npos();
+                    }
+                }
+                m_first_mask = 0;
+                std::fill(std::begin(m_second_mask), std::end(m_second_mask), size_t{ });
+                return sort(ret);
+            }
+
+            constexpr void update() noexcept
+            {
+                m_first_mask = 0;
+                for (size_t first { }; first < FirstNum; ++first)
+                {
+                    m_second_mask[first] = 0;
+                    for (size_t second { }; second < second_num(); ++second)
+                    {
+                        if (m_free[first][second] != npos()) { m_second_mask[first] |= size_t{1} << second; }
+                    }
+                    if (m_second_mask[first] != 0) { m_first_mask |= size_t{1} << first; }
+                }
+            }
+        };
+
+        constexpr size_t book_align() noexcept { return alignof(std::max_align_t); }
+    } // namespace memory_shelf_detail
+
+    // memory pool. memory come from the system one book at a time (assign), allocate / deallocate only edit page information.
+    // a book is PageNum pages of WordNum words, a word is WordTypeSize bytes.
+    // an allocation never cross a page, so the largest request is one page.
+    // requests are rounded up to granules of 16 bytes (at least one word) : a deallocated extent hold its own list header,
+    // so allocate / deallocate / restore never allocate.
+    // deallocated extents are kept per page in two level size classes (tlsf). a request is rounded up to the next class,
+    // so the first extent of the first non-empty class fit (good fit in O(1), only alignment can reject an extent).
+    // restore() defragment every page in one pass. restore_step() / restore_for() continue a running pass within a page or time budget,
+    // so defragmentation can be spread over many short calls.
+    // not thread safe unless Locked. a Locked shelf has a lock per book : allocate / deallocate / restore lock the book they touch
+    // (restore one page at a time), so a background thread can run restore_for() while other threads allocate.
+    // books never move once assigned.
+    template <size_t PageNum, size_t WordNum, typename WordType = unsigned char, size_t WordTypeSize = sizeof(WordType), bool Locked = false>
+        requires ((PageNum > 0) && (WordNum > 0) && (WordTypeSize > 0))
+    struct memory_shelf
+    {
+        private:
+            using policy = memory_shelf_policy::policy;
+            using extent = memory_shelf_detail::extent;
+            using page_info = memory_shelf_detail::page_info<memory_shelf_detail::first_num(WordNum), WordTypeSize>;
+
+            struct book
+            {
+                byte_t* m_memory;
+                sia::mutex m_lock;
+                page_info m_page[PageNum];
+
+                constexpr book(byte_t* memory)
+                    : m_memory(memory), m_lock(), m_page()
+                {
+                    for (size_t pos1 { }; pos1 < PageNum; ++pos1)
+                    { m_page[pos1].m_memory = memory + pos1 * page_bytes(); }
+                }
+            };
+
+            // hold the lock of a book when Locked.
+            struct book_guard
+            {
+                book& m_target;
+
+                constexpr book_guard(book& arg) noexcept
+                    : m_target(arg)
+                { if constexpr (Locked) { m_target.m_lock.lock(); } }
+
+                book_guard(const book_guard&) = delete;
+                book_guard& operator=(const book_guard&) = delete;
+
+                constexpr ~book_guard() noexcept
+                { if constexpr (Locked) { m_target.m_lock.unlock(); } }
+            };
+
+            static constexpr size_t page_bytes() noexcept { return WordNum * WordTypeSize; }
+            static constexpr size_t book_bytes() noexcept { return PageNum * page_bytes(); }
+            static constexpr size_t segment_num() noexcept { return std::numeric_limits<size_t>::digits; }
+
+            // segment n hold 2^n books, so growing the shelf never move a book.
+            book* m_segment[segment_num()];
+            std::atomic<size_t> m_size;     // books, published once the book is made
+            std::atomic<size_t> m_cursor;   // page of the last successful allocation (book * PageNum + page).
+            std::atomic<size_t> m_restore;  // next page of the running restore pass (modulo the page count).
+            sia::mutex m_grow;
+
+            static constexpr size_t unit_words() noexcept { return memory_shelf_detail::unit_words(WordTypeSize); }
+            // words of a request, rounded up to a granule.
+            static constexpr size_t word_count(size_t bytes) noexcept
+            {
+                const size_t words = std::max<size_t>((bytes + WordTypeSize - 1) / WordTypeSize, 1);
+                return (words + unit_words() - 1) / unit_words() * unit_words();
+            }
+
+            // {segment, index in the segment} of the book pos0.
+            static constexpr std::pair<size_t, size_t> segment_of(size_t pos0) noexcept
+            {
+                const size_t seg = static_cast<size_t>(std::bit_width(pos0 + 1)) - 1;
+                return {seg, pos0 + 1 - (size_t{1} << seg)};
+            }
+
+            constexpr book& get_book(size_t pos0) noexcept
+            {
+                const auto [seg, idx] = segment_of(pos0);
+                return m_segment[seg][idx];
+            }
+
+            constexpr const book& get_book(size_t pos0) const noexcept
+            {
+                const auto [seg, idx] = segment_of(pos0);
+                return m_segment[seg][idx];
+            }
+
+            constexpr byte_t* address(size_t pos0, size_t pos1, size_t pos2) noexcept
+            { return get_book(pos0).m_memory + pos1 * page_bytes() + pos2 * WordTypeSize; }
+
+            // first granule at or after pos whose address is aligned.
+            constexpr size_t align_word(size_t pos0, size_t pos1, size_t pos, size_t align) noexcept
+            {
+                while (reinterpret_cast<std::uintptr_t>(address(pos0, pos1, pos)) % align != 0)
+                { pos += unit_words(); }
+                return pos;
+            }
+
+            // cut [start, start + words) out of target, the rest go back to the page.
+            constexpr byte_t* split(size_t pos0, size_t pos1, extent target, size_t start, size_t words)
+            {
+                page_info& page = get_book(pos0).m_page[pos1];
+                if (start != target.m_pos)
+                { page.push(extent{target.m_pos, start - target.m_pos}); }
+                if (start + words != target.m_pos + target.m_size)
+                { page.push(extent{start + words, target.m_pos + target.m_size - start - words}); }
+                return address(pos0, pos1, start);
+            }
+
+            // first extent of the list of target that fit words at align, split out of it. nullptr when none fit.
+            constexpr byte_t* take_fit(size_t pos0, size_t pos1, memory_shelf_detail::class_pos target, size_t words, size_t align)
+            {
+                page_info& page = get_book(pos0).m_page[pos1];
+                size_t prev = memory_shelf_detail::npos();
+                for (size_t at = page.m_free[target.m_first][target.m_second]; at != memory_shelf_detail::npos();)
+                {
+                    const memory_shelf_detail::free_node cur = page.node(at);
+                    const size_t start = align_word(pos0, pos1, at, align);
+                    if (start + words <= at + cur.m_size)
+                    { return split(pos0, pos1, page.take(target, prev, at), start, words); }
+                    prev = at;
+                    at = cur.m_next;
+                }
+                return nullptr;
+            }
+
+            constexpr byte_t* take_deallocated(size_t pos0, size_t pos1, size_t words, size_t align)
+            {
+                page_info& page = get_book(pos0).m_page[pos1];
+                const memory_shelf_detail::class_pos upper = memory_shelf_detail::ceil_class(words);
+                memory_shelf_detail::class_pos target = upper;
+                while (page.find(target))
+                {
+                    if (byte_t* ret = take_fit(pos0, pos1, target, words, align); ret != nullptr)
+                    { return ret; }
+                    // every extent of the class is misaligned for this request.
+                    if (++target.m_second == memory_shelf_detail::second_num())
+                    {
+                        ++target.m_first;
+                        target.m_second = 0;
+                    }
+                }
+                // the class below hold extents of words too (perfect match), some of them large enough.
+                const memory_shelf_detail::class_pos lower = memory_shelf_detail::floor_class(words);
+                if (lower.m_first >= std::size(page.m_free) || (lower.m_first == upper.m_first && lower.m_second == upper.m_second))
+                { return nullptr; }
+                return take_fit(pos0, pos1, lower, words, align);
+            }
+
+            constexpr byte_t* take_sequential(size_t pos0, size_t pos1, size_t words, size_t align)
+            {
+                page_info& page = get_book(pos0).m_page[pos1];
+                if (page.m_top + words > WordNum)
+                { return nullptr; }
+                const size_t start = align_word(pos0, pos1, page.m_top, align);
+                if (start + words > WordNum)
+                { return nullptr; }
+                // the alignment gap become deallocated information.
+                if (start != page.m_top)
+                { page.push(extent{page.m_top, start - page.m_top}); }
+                page.m_top = start + words;
+                return address(pos0, pos1, start);
+            }
+
+            // concat adjacent deallocated extents of the page.
+            static constexpr void recycle_page(page_info& page) noexcept
+            {
+                size_t at = page.gather();
+                if (at == memory_shelf_detail::npos())
+                { return; }
+                extent run {at, page.node(at).m_size};
+                for (at = page.next_of(at); at != memory_shelf_detail::npos();)
+                {
+                    const memory_shelf_detail::free_node cur = page.node(at);
+                    if (run.m_pos + run.m_size == at)
+                    { run.m_size += cur.m_size; }
+                    else
+                    {
+                        page.push(run);
+                        run = extent{at, cur.m_size};
+                    }
+                    at = cur.m_next;
+                }
+                page.push(run);
+            }
+
+            // deallocated extents that reach the sequential memory become sequential memory again.
+            static constexpr void recover_page(page_info& page) noexcept
+            {
+                const size_t head = page.gather();
+                // start of the last run of adjacent extents, and its end.
+                size_t run = memory_shelf_detail::npos();
+                size_t end = memory_shelf_detail::npos();
+                for (size_t at = head; at != memory_shelf_detail::npos();)
+                {
+                    const memory_shelf_detail::free_node cur = page.node(at);
+                    if (at != end) { run = at; }
+                    end = at + cur.m_size;
+                    at = cur.m_next;
+                }
+                const bool reach = end == page.m_top;
+                for (size_t at = head; at != memory_shelf_detail::npos() && !(reach && at == run);)
+                {
+                    const memory_shelf_detail::free_node cur = page.node(at);
+                    page.push(extent{at, cur.m_size});
+                    at = cur.m_next;
+                }
+                if (reach)
+                { page.m_top = run; }
+            }
+
+            // a page without deallocated extent is skipped.
+            static constexpr void restore_page(page_info& page)
+            {
+                if (page.m_first_mask == 0)
+                { return; }
+                recycle_page(page);
+                recover_page(page);
+                page.update();
+            }
+
+            // the book pos0 is locked by the caller.
+            constexpr byte_t* page_allocate(size_t pos0, size_t pos1, size_t words, size_t align, policy ptag)
+            {
+                byte_t* ret = nullptr;
+                switch (ptag)
+                {
+                    case policy::none:
+                        ret = take_deallocated(pos0, pos1, words, align);
+                        if (ret == nullptr) { ret = take_sequential(pos0, pos1, words, align); }
+                        break;
+                    case policy::poor:
+                        ret = take_deallocated(pos0, pos1, words, align);
+                        break;
+                    case policy::rich:
+                        ret = take_sequential(pos0, pos1, words, align);
+                        break;
+                    case policy::thrifty:
+                        recycle_page(get_book(pos0).m_page[pos1]);
+                        ret = take_deallocated(pos0, pos1, words, align);
+                        recover_page(get_book(pos0).m_page[pos1]);
+                        get_book(pos0).m_page[pos1].update();
+                        break;
+                }
+                return ret;
+            }
+
+            constexpr void* allocate_bytes(size_t bytes, size_t align, policy ptag)
+            {
+                const size_t words = word_count(bytes);
+                const size_t page_num = shelf_size() * PageNum;
+                if (words > WordNum || page_num == 0)
+                { return nullptr; }
+                const size_t cursor = m_cursor.load(std::memory_order::relaxed);
+                for (size_t step { }; step < page_num; ++step)
+                {
+                    const size_t at = (cursor + step) % page_num;
+                    book_guard guard {get_book(at / PageNum)};
+                    if (byte_t* ret = page_allocate(at / PageNum, at % PageNum, words, align, ptag); ret != nullptr)
+                    {
+                        m_cursor.store(at, std::memory_order::relaxed);
+                        return ret;
+                    }
+                }
+                return nullptr;
+            }
+
+        public:
+            constexpr memory_shelf(size_t book_num = 0)
+                : m_segment(), m_size(0), m_cursor(0), m_restore(0), m_grow()
+            { assign(book_num); }
+
+            memory_shelf(const memory_shelf&) = delete;
+            memory_shelf& operator=(const memory_shelf&) = delete;
+
+            ~memory_shelf() noexcept
+            {
+                const size_t count = m_size.load(std::memory_order::acquire);
+                for (size_t pos0 { }; pos0 < count; ++pos0)
+                {
+                    book& target = get_book(pos0);
+                    ::operator delete(target.m_memory, std::align_val_t{memory_shelf_detail::book_align()});
+                    std::destroy_at(&target);
+                }
+                for (size_t seg { }; seg < segment_num(); ++seg)
+                {
+                    if (m_segment[seg] != nullptr)
+                    { std::allocator<book>{ }.deallocate(m_segment[seg], size_t{1} << seg); }
+                }
+            }
+
+            static constexpr size_t word_size() noexcept { return WordTypeSize; }
+            static constexpr size_t page_size() noexcept { return WordNum; }
+            static constexpr size_t book_size() noexcept { return PageNum; }
+            static constexpr bool is_locked() noexcept { return Locked; }
+            constexpr size_t shelf_size() const noexcept { return m_size.load(std::memory_order::acquire); }
+            // bytes
+            constexpr size_t capacity() const noexcept { return shelf_size() * book_bytes(); }
+
+            // add num books. the only place memory_shelf get memory from the system.
+            constexpr void assign(size_t num)
+            {
+                quota guard {m_grow};
+                size_t count = m_size.load(std::memory_order::relaxed);
+                for (size_t idx { }; idx < num; ++idx, ++count)
+                {
+                    const auto [seg, at] = segment_of(count);
+                    if (m_segment[seg] == nullptr)
+                    { m_segment[seg] = std::allocator<book>{ }.allocate(size_t{1} << seg); }
+                    byte_t* memory = static_cast<byte_t*>(::operator new(book_bytes(), std::align_val_t{memory_shelf_detail::book_align()}));
+                    std::construct_at(m_segment[seg] + at, memory);
+                    m_size.store(count + 1, std::memory_order::release);
+                }
+            }
+
+            // nullptr when no page can serve the request under the policy.
+            template <typename T = WordType>
+            constexpr T* allocate(size_t num = 1, policy ptag = policy::none)
+            {
+                static_assert(alignof(T) <= memory_shelf_detail::book_align(), "Error : over aligned type");
+                return static_cast<T*>(allocate_bytes(num * sizeof(T), alignof(T), ptag));
+            }
+
+            // allocate in the book pos0 only.
+            template <typename T = WordType>
+            constexpr T* allocate(size_t pos0, size_t num, policy ptag = policy::none)
+            {
+                static_assert(alignof(T) <= memory_shelf_detail::book_align(), "Error : over aligned type");
+                assertm(pos0 < shelf_size(), "Error : memory_shelf book position out of range");
+                const size_t words = word_count(num * sizeof(T));
+                if (words > WordNum)
+                { return nullptr; }
+                book_guard guard {get_book(pos0)};
+                for (size_t pos1 { }; pos1 < PageNum; ++pos1)
+                {
+                    if (byte_t* ret = page_allocate(pos0, pos1, words, alignof(T), ptag); ret != nullptr)
+                    { return reinterpret_cast<T*>(ret); }
+                }
+                return nullptr;
+            }
+
+            // allocate in the page pos1 of the book pos0 only.
+            template <typename T = WordType>
+            constexpr T* allocate(size_t pos0, size_t pos1, size_t num, policy ptag = policy::none)
+            {
+                static_assert(alignof(T) <= memory_shelf_detail::book_align(), "Error : over aligned type");
+                assertm(pos0 < shelf_size() && pos1 < PageNum, "Error : memory_shelf page position out of range");
+                const size_t words = word_count(num * sizeof(T));
+                if (words > WordNum)
+                { return nullptr; }
+                book_guard guard {get_book(pos0)};
+                return reinterpret_cast<T*>(page_allocate(pos0, pos1, words, alignof(T), ptag));
+            }
+
+            // num must be the num given to allocate.
+            template <typename T>
+            constexpr void deallocate(T* ptr, size_t num = 1) noexcept
+            {
+                const auto [valid, pos0, pos1, pos2] = addr_pos(ptr);
+                assertm(valid, "Error : pointer is not from this memory_shelf");
+                book& target = get_book(pos0);
+                book_guard guard {target};
+                target.m_page[pos1].push(extent{pos2, word_count(num * sizeof(T))});
+            }
+
+            // {is_valid, book, page, word} of an address.
+            constexpr std::tuple<bool, size_t, size_t, size_t> addr_pos(const void* ptr) const noexcept
+            {
+                const byte_t* target = static_cast<const byte_t*>(ptr);
+                const size_t count = shelf_size();
+                for (size_t pos0 { }; pos0 < count; ++pos0)
+                {
+                    const byte_t* memory = get_book(pos0).m_memory;
+                    if (target >= memory && target < memory + book_bytes())
+                    {
+                        const size_t offset = static_cast<size_t>(target - memory);
+                        return {true, pos0, offset / page_bytes(), (offset % page_bytes()) / WordTypeSize};
+                    }
+                }
+                return {false, 0, 0, 0};
+            }
+
+            // concat adjacent deallocated extents of the page.
+            constexpr void recycle(size_t pos0, size_t pos1)
+            {
+                book& target = get_book(pos0);
+                book_guard guard {target};
+                recycle_page(target.m_page[pos1]);
+            }
+
+            // deallocated extents that reach the sequential memory become sequential memory again.
+            constexpr void recover(size_t pos0, size_t pos1)
+            {
+                book& target = get_book(pos0);
+                book_guard guard {target};
+                recover_page(target.m_page[pos1]);
+            }
+
+            // rebuild the class bitmaps of the page.
+            constexpr void update_page(size_t pos0, size_t pos1) noexcept
+            {
+                book& target = get_book(pos0);
+                book_guard guard {target};
+                target.m_page[pos1].update();
+            }
+
+            constexpr void restore(size_t pos0, size_t pos1)
+            {
+                book& target = get_book(pos0);
+                book_guard guard {target};
+                restore_page(target.m_page[pos1]);
+            }
+
+            constexpr void restore(size_t pos0)
+            {
+                for (size_t pos1 { }; pos1 < PageNum; ++pos1)
+                { restore(pos0, pos1); }
+            }
+
+            constexpr void restore()
+            {
+                const size_t count = shelf_size();
+                for (size_t pos0 { }; pos0 < count; ++pos0)
+                { restore(pos0); }
+            }
+
+            // restore the next page_budget pages of the running pass. a pass visit every page once, then the next one start.
+            // several threads may step together, each page of the pass go to one of them.
+            // true when the last page of a pass was restored by this call.
+            constexpr bool restore_step(size_t page_budget = PageNum)
+            {
+                const size_t page_num = shelf_size() * PageNum;
+                if (page_num == 0)
+                { return false; }
+                bool ret = false;
+                for (size_t count { }; count < page_budget; ++count)
+                {
+                    const size_t at = m_restore.fetch_add(1, std::memory_order::relaxed) % page_num;
+                    restore(at / PageNum, at % PageNum);
+                    ret = ret || (at + 1 == page_num);
+                }
+                return ret;
+            }
+
+            // restore pages of the running pass until budget is spent or the pass end (true when it ended).
+            // the clock is read after each page, so a call overrun budget by at most one page restore.
+            template <typename Rep, typename Period>
+            bool restore_for(std::chrono::duration<Rep, Period> budget)
+            {
+                if (shelf_size() == 0)
+                { return false; }
+                single_recorder sr { };
+                sr.set();
+                do
+                {
+                    if (restore_step(1))
+                    { return true; }
+                    sr.now();
+                } while (sr.result() < budget);
+                return false;
+            }
+    };
+
+    // memory_shelf with a lock per book, to restore on a background thread (restore_for) while other threads allocate.
+    template <size_t PageNum, size_t WordNum, typename WordType = unsigned char, size_t WordTypeSize = sizeof(WordType)>
+    using locked_memory_shelf = memory_shelf<PageNum, WordNum, WordType, WordTypeSize, true>;
+
+    // standard allocator over a memory_shelf. the shelf must outlive every allocator and container using it.
+    // a request that no page can serve restore the next book worth of pages (restore_step) and retry, then assign one more book.
+    // the pause of a failing request is bounded by one book, a full restore() is left to the user (or a background thread on a locked shelf).
+    // requests larger than one page throw std::bad_alloc.
+    template <typename T, typename Shelf>
+    struct memory_shelf_allocator
+    {
+            template <typename, typename>
+            friend struct memory_shelf_allocator;
+        private:
+            Shelf* m_shelf;
+
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = std::true_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+            using is_always_equal = std::false_type;
+
+            template <typename Ty>
+            struct rebind { using other = memory_shelf_allocator<Ty, Shelf>; };
+
+            constexpr memory_shelf_allocator(Shelf& shelf) noexcept
+                : m_shelf(&shelf)
+            { }
+
+            template <typename Ty>
+            constexpr memory_shelf_allocator(const memory_shelf_allocator<Ty, Shelf>& arg) noexcept
+                : m_shelf(arg.m_shelf)
+            { }
+
+            constexpr Shelf& shelf() const noexcept { return *m_shelf; }
+
+            [[nodiscard]] constexpr T* allocate(size_t num)
+            {
+                if (num * sizeof(T) > Shelf::page_size() * Shelf::word_size())
+                { throw std::bad_alloc{ }; }
+                T* ret = m_shelf->template allocate<T>(num);
+                if (ret == nullptr)
+                {
+                    m_shelf->restore_step(Shelf::book_size());
+                    ret = m_shelf->template allocate<T>(num);
+                }
+                if (ret == nullptr)
+                {
+                    m_shelf->assign(1);
+                    ret = m_shelf->template allocate<T>(num);
+                }
+                if (ret == nullptr)
+                { throw std::bad_alloc{ }; }
+                return ret;
+            }
+
+            constexpr void deallocate(T* ptr, size_t num) noexcept
+            { m_shelf->deallocate(ptr, num); }
+
+            template <typename Ty>
+            friend constexpr bool operator==(const memory_shelf_allocator& lhs, const memory_shelf_allocator<Ty, Shelf>& rhs) noexcept
+            { return lhs.m_shelf == rhs.m_shelf; }
+    };
+} // namespace sia
@@ -0,0 +1,435 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/internals/define.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/memory/resource.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+
+#if defined(SIA_OS_LINUX)
+    #include <sched.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace sia
+{
+    namespace numa_detail
+    {
+        constexpr size_t max_node() noexcept { return 64; }
+        constexpr size_t class_num() noexcept { return 64; }
+        constexpr size_t min_block() noexcept { return 16; }
+        constexpr size_t page_size() noexcept { return 4096; }
+        // mbind modes (linux/mempolicy.h).
+        constexpr int preferred_mode() noexcept { return 1; }
+        constexpr int bind_mode() noexcept { return 2; }
+
+        constexpr size_t class_of(size_t bytes, size_t align) noexcept
+        { return static_cast<size_t>(std::bit_width(std::max({bytes, align, min_block()}) - 1)); }
+
+        constexpr size_t round_up(size_t value, size_t unit) noexcept
+        { return (value + unit - 1) / unit * unit; }
+
+        #if defined(SIA_OS_LINUX)
+            // call func(first, last) for each range of a sysfs list ("0-3,8,10-11"). false when the file can not be read.
+            template <typename Func>
+            bool read_list(const char* path, Func func) noexcept
+            {
+                char buffer[1024] { };
+                const int fd = ::open(path, O_RDONLY);
+                if (fd < 0)
+                { return false; }
+                const ssize_t len = ::read(fd, buffer, sizeof(buffer) - 1);
+                ::close(fd);
+                if (len <= 0)
+                { return false; }
+                for (const char* at = buffer; *at >= '0' && *at <= '9';)
+                {
+                    size_t first { };
+                    while (*at >= '0' && *at <= '9') { first = first * 10 + static_cast<size_t>(*at++ - '0'); }
+                    size_t last = first;
+                    if (*at == '-')
+                    {
+                        last = 0;
+                        for (++at; *at >= '0' && *at <= '9'; ++at) { last = last * 10 + static_cast<size_t>(*at - '0'); }
+                    }
+                    func(first, last);
+                    if (*at == ',') { ++at; }
+                }
+                return true;
+            }
+
+            // cpus of a node, false when unknown.
+            inline bool node_cpus(size_t node, ::cpu_set_t& target) noexcept
+            {
+                char path[64] = "/sys/devices/system/node/node";
+                char* at = path + sizeof("/sys/devices/system/node/node") - 1;
+                char digit[8] { };
+                size_t len { };
+                do { digit[len++] = static_cast<char>('0' + node % 10); node /= 10; } while (node != 0);
+                while (len != 0) { *at++ = digit[--len]; }
+                std::copy_n("/cpulist", sizeof("/cpulist"), at);
+                CPU_ZERO(&target);
+                bool any = false;
+                const bool read = read_list(path, [&target, &any] (size_t first, size_t last) noexcept
+                {
+                    for (size_t cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+                    {
+                        CPU_SET(cpu, &target);
+                        any = true;
+                    }
+                });
+                return read && any;
+            }
+
+            // bind [ptr, ptr + size) to node. strict fail the fault when the node is full, otherwise other nodes take over.
+            inline bool bind(void* ptr, size_t size, size_t node, bool strict) noexcept
+            {
+                #if defined(SYS_mbind)
+                    unsigned long mask = 1UL << node;
+                    return ::syscall(SYS_mbind, ptr, size, strict ? bind_mode() : preferred_mode(), &mask, max_node() + 1, 0) == 0;
+                #else
+                    return false;
+                #endif
+            }
+
+            // fault every page of [ptr, ptr + size) from the calling thread.
+            inline void touch(void* ptr, size_t size) noexcept
+            {
+                #if defined(MADV_POPULATE_WRITE)
+                    if (::madvise(ptr, size, MADV_POPULATE_WRITE) == 0)
+                    { return; }
+                #endif
+                for (size_t offset { }; offset < size; offset += page_size())
+                { static_cast<volatile byte_t*>(ptr)[offset] = byte_t{ }; }
+            }
+
+            // fault the pages from a cpu of node (first touch place them there), the calling thread move to the node meanwhile.
+            // touched from where the thread run when the node cpus are unknown.
+            inline void touch_on(void* ptr, size_t size, size_t node) noexcept
+            {
+                ::cpu_set_t saved { };
+                ::cpu_set_t target { };
+                if (!node_cpus(node, target) || ::sched_getaffinity(0, sizeof(saved), &saved) != 0 || ::sched_setaffinity(0, sizeof(target), &target) != 0)
+                {
+                    touch(ptr, size);
+                    return;
+                }
+                touch(ptr, size);
+                ::sched_setaffinity(0, sizeof(saved), &saved);
+            }
+        #endif
+
+        // online nodes (1 when the system has no numa information). "possible" would count nodes that can never come up.
+        inline size_t node_count() noexcept
+        {
+            #if defined(SIA_OS_LINUX)
+                static const size_t ret = [] () noexcept
+                {
+                    size_t num = 1;
+                    read_list("/sys/devices/system/node/online", [&num] (size_t, size_t last) noexcept { num = std::max(num, last + 1); });
+                    return std::min(num, max_node());
+                }();
+                return ret;
+            #else
+                return 1;
+            #endif
+        }
+
+        #if defined(SIA_OS_LINUX)
+            // bit n set when node n has memory. node ids can have holes and a node can have cpus only.
+            // every node when the system does not tell.
+            inline size_t memory_nodes() noexcept
+            {
+                static const size_t ret = [] () noexcept
+                {
+                    size_t mask { };
+                    const bool read = read_list("/sys/devices/system/node/has_memory", [&mask] (size_t first, size_t last) noexcept
+                    {
+                        for (size_t node = first; node <= last && node < max_node(); ++node)
+                        { mask |= size_t{1} << node; }
+                    });
+                    return read && mask != 0 ? mask : ~size_t{ };
+                }();
+                return ret;
+            }
+        #endif
+
+        // node of the cpu the calling thread run on (getcpu), 0 when unknown.
+        inline size_t current_node() noexcept
+        {
+            #if defined(SIA_OS_LINUX)
+                unsigned int cpu { };
+                unsigned int node { };
+                #if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+                    if (::getcpu(&cpu, &node) != 0) { return 0; }
+                #else
+                    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) { return 0; }
+                #endif
+                return std::min<size_t>(node, node_count() - 1);
+            #else
+                return 0;
+            #endif
+        }
+
+        // power of two blocks over the address range of one node. blocks are aligned to their size up to a page, and to align above it.
+        // free blocks are kept per size, linked through their first word. the range past m_top was never touched.
+        struct arena
+        {
+            byte_t* m_base = nullptr;
+            size_t m_capacity = 0;
+            size_t m_top = 0;
+            size_t m_node = 0;
+            bool m_memory = true;   // the node has memory, otherwise its allocations go to other nodes.
+            void* m_free[class_num()] { };
+            sia::mutex m_lock;
+
+            // {block, is the block fresh (never touched)}. nullptr when the range is full.
+            std::pair<void*, bool> allocate(size_t bytes, size_t align) noexcept
+            {
+                const size_t idx = class_of(bytes, align);
+                if (idx >= class_num())
+                { return {nullptr, false}; }
+                const size_t size = size_t{1} << idx;
+                const size_t unit = std::max(std::min(size, page_size()), align);
+                quota guard {m_lock};
+                if (void* at = m_free[idx]; at != nullptr && reinterpret_cast<std::uintptr_t>(at) % align == 0)
+                {
+                    m_free[idx] = *static_cast<void**>(at);
+                    return {at, false};
+                }
+                // the base is only page aligned : align the address, not the offset.
+                const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_base);
+                const size_t at = round_up(base + m_top, unit) - base;
+                if (at > m_capacity || size > m_capacity - at)
+                { return {nullptr, false}; }
+                m_top = at + size;
+                return {m_base + at, true};
+            }
+
+            void deallocate(void* ptr, size_t bytes, size_t align) noexcept
+            {
+                const size_t idx = class_of(bytes, align);
+                quota guard {m_lock};
+                *static_cast<void**>(ptr) = m_free[idx];
+                m_free[idx] = ptr;
+            }
+
+            size_t used() noexcept
+            {
+                quota guard {m_lock};
+                return m_top;
+            }
+        };
+
+        struct region
+        {
+            byte_t* m_base;
+            size_t m_node_capacity;
+            size_t m_node_num;
+        };
+    } // namespace numa_detail
+
+    // node of the cpu the calling thread run on.
+    inline size_t numa_node() noexcept { return numa_detail::current_node(); }
+    // nodes of the system, 1 without numa.
+    inline size_t numa_node_count() noexcept { return numa_detail::node_count(); }
+
+    struct numa_resource;
+
+    // memory resource of one node of a numa_resource : its blocks live on that node.
+    // any resource of the same numa_resource can free them.
+    struct numa_node_resource final : public std::pmr::memory_resource
+    {
+            friend struct numa_resource;
+        private:
+            numa_detail::arena m_arena;
+            numa_resource* m_owner;
+
+            void* do_allocate(size_t bytes, size_t align) override;
+            void do_deallocate(void* ptr, size_t bytes, size_t align) override;
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override;
+
+        public:
+            numa_node_resource() noexcept
+                : m_arena(), m_owner(nullptr)
+            { }
+
+            numa_node_resource(const numa_node_resource&) = delete;
+            numa_node_resource& operator=(const numa_node_resource&) = delete;
+
+            size_t node() const noexcept { return m_arena.m_node; }
+            // bytes of the node range handed out so far (free blocks included).
+            size_t used() noexcept { return m_arena.used(); }
+            numa_resource& owner() const noexcept { return *m_owner; }
+    };
+
+    // node-aware memory resource : one arena per numa node, allocate take the arena of the node the calling thread run on (getcpu),
+    // node(idx) give the resource of a chosen node (the node of the thread that will use the memory, e.g. the consumer of a ring).
+    // each node own a range of address space (node_capacity bytes, reserved without memory) bound to it with mbind,
+    // so pages land on the node whoever touch them first. when mbind is not available (no numa kernel, seccomp ...)
+    // and populate is true, new blocks are first touched from a cpu of their node (the calling thread move there meanwhile).
+    // populate also pre-fault the pages, so the first pass over a ring do not pay the page faults.
+    // strict : a full node fail the page fault (mbind MPOL_BIND) instead of taking memory from another node (MPOL_PREFERRED).
+    // a full node arena fall back to the next nodes, std::bad_alloc when every arena is full.
+    // on a single node system everything behave as one node. other systems than linux get aligned ::operator new.
+    // thread safe (a lock per node arena) : allocate big blocks (container storage), not objects.
+    struct numa_resource final : public std::pmr::memory_resource
+    {
+            friend struct numa_node_resource;
+        private:
+            numa_detail::region m_region;
+            std::unique_ptr<numa_node_resource[]> m_node;
+            bool m_populate;
+            bool m_bound;
+
+            void* allocate_on(size_t idx, size_t bytes, size_t align)
+            {
+                #if !defined(SIA_OS_LINUX)
+                    return ::operator new(bytes, std::align_val_t{std::max(align, numa_detail::min_block())});
+                #endif
+                for (size_t step { }; step < m_region.m_node_num; ++step)
+                {
+                    numa_detail::arena& target = m_node[(idx + step) % m_region.m_node_num].m_arena;
+                    if (!target.m_memory)
+                    { continue; }
+                    const auto [ret, fresh] = target.allocate(bytes, align);
+                    if (ret == nullptr)
+                    { continue; }
+                    #if defined(SIA_OS_LINUX)
+                        if (fresh && m_populate)
+                        {
+                            const size_t size = size_t{1} << numa_detail::class_of(bytes, align);
+                            if (m_bound || m_region.m_node_num == 1)
+                            { numa_detail::touch(ret, size); }
+                            else
+                            { numa_detail::touch_on(ret, size, target.m_node); }
+                        }
+                    #endif
+                    return ret;
+                }
+                throw std::bad_alloc{ };
+            }
+
+            void release(void* ptr, size_t bytes, size_t align) noexcept
+            {
+                #if !defined(SIA_OS_LINUX)
+                    ::operator delete(ptr, std::align_val_t{std::max(align, numa_detail::min_block())});
+                    return;
+                #endif
+                const size_t idx = node_of(ptr);
+                assertm(idx < m_region.m_node_num, "Error : pointer is not from this numa_resource");
+                m_node[idx].m_arena.deallocate(ptr, bytes, align);
+            }
+
+            void* do_allocate(size_t bytes, size_t align) override
+            { return allocate_on(numa_detail::current_node() % m_region.m_node_num, bytes, align); }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t align) override
+            { release(ptr, bytes, align); }
+
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            {
+                if (const numa_resource* other = dynamic_cast<const numa_resource*>(&arg); other != nullptr)
+                { return other == this; }
+                const numa_node_resource* other = dynamic_cast<const numa_node_resource*>(&arg);
+                return other != nullptr && other->m_owner == this;
+            }
+
+        public:
+            // node_capacity : address space of each node (no memory is taken until used).
+            numa_resource(size_t node_capacity = size_t{1} << 34, bool populate = false, bool strict = false)
+                : m_region{nullptr, numa_detail::round_up(std::max(node_capacity, numa_detail::page_size()), numa_detail::page_size()), numa_detail::node_count()},
+                  m_node(), m_populate(populate), m_bound(false)
+            {
+                #if defined(SIA_OS_LINUX)
+                    const size_t total = m_region.m_node_capacity * m_region.m_node_num;
+                    void* raw = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                    if (raw == MAP_FAILED)
+                    { throw std::bad_alloc{ }; }
+                    m_region.m_base = static_cast<byte_t*>(raw);
+                #endif
+                m_node = std::make_unique<numa_node_resource[]>(m_region.m_node_num);
+                m_bound = m_region.m_node_num > 1;
+                for (size_t idx { }; idx < m_region.m_node_num; ++idx)
+                {
+                    numa_node_resource& target = m_node[idx];
+                    target.m_owner = this;
+                    target.m_arena.m_base = m_region.m_base + idx * m_region.m_node_capacity;
+                    target.m_arena.m_capacity = m_region.m_node_capacity;
+                    target.m_arena.m_node = idx;
+                    #if defined(SIA_OS_LINUX)
+                        target.m_arena.m_memory = ((numa_detail::memory_nodes() >> idx) & 1) != 0;
+                        if (m_region.m_node_num > 1 && target.m_arena.m_memory)
+                        { m_bound = numa_detail::bind(target.m_arena.m_base, m_region.m_node_capacity, idx, strict) && m_bound; }
+                    #endif
+                }
+            }
+
+            numa_resource(const numa_resource&) = delete;
+            numa_resource& operator=(const numa_resource&) = delete;
+
+            // the whole range go back to the system, objects still out are not destroyed.
+            ~numa_resource() noexcept override
+            {
+                #if defined(SIA_OS_LINUX)
+                    ::munmap(m_region.m_base, m_region.m_node_capacity * m_region.m_node_num);
+                #endif
+            }
+
+            size_t node_count() const noexcept { return m_region.m_node_num; }
+            size_t node_capacity() const noexcept { return m_region.m_node_capacity; }
+            // the range of every node with memory is bound with mbind (false on a single node, where there is nothing to bind).
+            bool is_bound() const noexcept { return m_bound; }
+            bool populate() const noexcept { return m_populate; }
+
+            numa_node_resource& node(size_t idx) noexcept
+            {
+                assertm(idx < m_region.m_node_num, "Error : numa node out of range");
+                return m_node[idx];
+            }
+
+            // resource of the node the calling thread run on.
+            numa_node_resource& local() noexcept { return m_node[numa_detail::current_node() % m_region.m_node_num]; }
+
+            // node whose range hold ptr (node_count() when ptr is not from this resource).
+            size_t node_of(const void* ptr) const noexcept
+            {
+                const byte_t* target = static_cast<const byte_t*>(ptr);
+                if (target < m_region.m_base || target >= m_region.m_base + m_region.m_node_capacity * m_region.m_node_num)
+                { return m_region.m_node_num; }
+                return static_cast<size_t>(target - m_region.m_base) / m_region.m_node_capacity;
+            }
+    };
+
+    inline void* numa_node_resource::do_allocate(size_t bytes, size_t align)
+    { return m_owner->allocate_on(m_arena.m_node, bytes, align); }
+
+    inline void numa_node_resource::do_deallocate(void* ptr, size_t bytes, size_t align)
+    { m_owner->release(ptr, bytes, align); }
+
+    inline bool numa_node_resource::do_is_equal(const std::pmr::memory_resource& arg) const noexcept
+    {
+        if (const numa_node_resource* other = dynamic_cast<const numa_node_resource*>(&arg); other != nullptr)
+        { return other->m_owner == m_owner; }
+        return dynamic_cast<const numa_resource*>(&arg) == m_owner;
+    }
+
+    template <typename T>
+    using numa_allocator = resource_allocator<T, numa_resource>;
+
+    template <typename T>
+    using numa_node_allocator = resource_allocator<T, numa_node_resource>;
+} // namespace sia
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <compare>
+#include <iterator>
+#include <type_traits>
+
+#include "SIA/internals/types.hpp"
+
+namespace sia
+{
+    // self-relative pointer : hold the distance from itself to the target, so it stay valid when the memory
+    // holding both is mapped at another address (shared memory, mapped files).
+    // copying recompute the distance from the new location. distance 0 is null (an offset_ptr can not point to itself).
+    template <typename T>
+    struct offset_ptr
+    {
+            template <typename Ty>
+            friend struct offset_ptr;
+        private:
+            std::ptrdiff_t m_offset;
+
+            std::ptrdiff_t distance(const volatile void* target) const noexcept
+            {
+                return target == nullptr ? 0 : reinterpret_cast<std::intptr_t>(target)
+                    - reinterpret_cast<std::intptr_t>(this);
+            }
+
+        public:
+            using element_type = T;
+            using value_type = std::remove_cv_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using iterator_category = std::random_access_iterator_tag;
+
+            offset_ptr() noexcept : m_offset(0) { }
+            offset_ptr(std::nullptr_t) noexcept : m_offset(0) { }
+            offset_ptr(T* ptr) noexcept : m_offset(distance(ptr)) { }
+            offset_ptr(const offset_ptr& arg) noexcept : m_offset(distance(arg.get())) { }
+            template <typename Ty>
+                requires (std::is_convertible_v<Ty*, T*>)
+            offset_ptr(const offset_ptr<Ty>& arg) noexcept : m_offset(distance(static_cast<T*>(arg.get()))) { }
+
+            offset_ptr& operator=(const offset_ptr& arg) noexcept
+            {
+                m_offset = distance(arg.get());
+                return *this;
+            }
+
+            offset_ptr& operator=(T* ptr) noexcept
+            {
+                m_offset = distance(ptr);
+                return *this;
+            }
+
+            T* get() const noexcept
+            {
+                return m_offset == 0 ? nullptr : reinterpret_cast<T*>(reinterpret_cast<std::intptr_t>(this) + m_offset);
+            }
+
+            T& operator*() const noexcept requires (!std::is_void_v<T>) { return *get(); }
+            T* operator->() const noexcept { return get(); }
+            T& operator[](std::ptrdiff_t idx) const noexcept requires (!std::is_void_v<T>) { return get()[idx]; }
+            explicit operator bool() const noexcept { return m_offset != 0; }
+            operator T*() const noexcept { return get(); }
+
+            static offset_ptr pointer_to(T& arg) noexcept requires (!std::is_void_v<T>) { return offset_ptr{&arg}; }
+
+            offset_ptr& operator+=(std::ptrdiff_t num) noexcept { m_offset += num * static_cast<std::ptrdiff_t>(sizeof(T)); return *this; }
+            offset_ptr& operator-=(std::ptrdiff_t num) noexcept { m_offset -= num * static_cast<std::ptrdiff_t>(sizeof(T)); return *this; }
+            offset_ptr& operator++() noexcept { return *this += 1; }
+            offset_ptr& operator--() noexcept { return *this -= 1; }
+            offset_ptr operator++(int) noexcept { offset_ptr ret {*this}; ++*this; return ret; }
+            offset_ptr operator--(int) noexcept { offset_ptr ret {*this}; --*this; return ret; }
+            friend offset_ptr operator+(const offset_ptr& lhs, std::ptrdiff_t num) noexcept { return offset_ptr{lhs.get() + num}; }
+            friend offset_ptr operator-(const offset_ptr& lhs, std::ptrdiff_t num) noexcept { return offset_ptr{lhs.get() - num}; }
+            friend std::ptrdiff_t operator-(const offset_ptr& lhs, const offset_ptr& rhs) noexcept { return lhs.get() - rhs.get(); }
+
+            friend bool operator==(const offset_ptr& lhs, const offset_ptr& rhs) noexcept { return lhs.get() == rhs.get(); }
+            friend std::strong_ordering operator<=>(const offset_ptr& lhs, const offset_ptr& rhs) noexcept { return lhs.get() <=> rhs.get(); }
+    };
+} // namespace sia
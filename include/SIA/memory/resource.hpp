@@ -1,6 +1,70 @@
 #pragma once
 
+#include <new>
+#include <concepts>
+#include <type_traits>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+
 namespace sia
 {
-    
+    namespace resource_detail
+    {
+        template <typename T>
+        concept ResourceAble = requires (T arg, void* ptr, size_t bytes, size_t align)
+        {
+            { arg.allocate(bytes, align) } -> std::same_as<void*>;
+            arg.deallocate(ptr, bytes, align);
+        };
+    } // namespace resource_detail
+
+    // standard allocator over a memory resource (std::pmr::memory_resource or anything with the same allocate / deallocate).
+    // unlike std::pmr::polymorphic_allocator it keep the concrete resource type, so calls to a final resource are not virtual,
+    // and it propagate with the container. the resource must outlive every allocator and container using it.
+    template <typename T, typename Resource = std::pmr::memory_resource>
+        requires (resource_detail::ResourceAble<Resource>)
+    struct resource_allocator
+    {
+            template <typename Ty, typename Re>
+                requires (resource_detail::ResourceAble<Re>)
+            friend struct resource_allocator;
+        private:
+            Resource* m_resource;
+
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = std::true_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+            using is_always_equal = std::false_type;
+
+            template <typename Ty>
+            struct rebind { using other = resource_allocator<Ty, Resource>; };
+
+            constexpr resource_allocator(Resource& resource) noexcept
+                : m_resource(&resource)
+            { }
+
+            template <typename Ty>
+            constexpr resource_allocator(const resource_allocator<Ty, Resource>& arg) noexcept
+                : m_resource(arg.m_resource)
+            { }
+
+            constexpr Resource& resource() const noexcept { return *m_resource; }
+
+            [[nodiscard]] constexpr T* allocate(size_t num)
+            {
+                if (num > static_cast<size_t>(-1) / sizeof(T))
+                { throw std::bad_array_new_length{ }; }
+                return static_cast<T*>(m_resource->allocate(num * sizeof(T), alignof(T)));
+            }
+
+            constexpr void deallocate(T* ptr, size_t num) noexcept
+            { m_resource->deallocate(ptr, num * sizeof(T), alignof(T)); }
+
+            template <typename Ty>
+            friend constexpr bool operator==(const resource_allocator& lhs, const resource_allocator<Ty, Resource>& rhs) noexcept
+            { return lhs.m_resource == rhs.m_resource; }
+    };
 } // namespace sia
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/container/stack.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+#include "SIA/memory/resource.hpp"
+
+namespace sia
+{
+    namespace slab_detail
+    {
+        // size classes : 16 ~ 128 by 16, then 4 steps per power of two up to 4096.
+        constexpr size_t class_num() noexcept { return 28; }
+        constexpr size_t max_size() noexcept { return 4096; }
+        constexpr size_t max_align() noexcept { return 64; }
+
+        constexpr size_t class_of(size_t size) noexcept
+        {
+            if (size <= 128)
+            { return size == 0 ? 0 : (size + 15) / 16 - 1; }
+            const size_t power = static_cast<size_t>(std::bit_width(size - 1));
+            const size_t base = size_t{1} << (power - 1);
+            const size_t step = base / 4;
+            return 8 + (power - 8) * 4 + (size - base + step - 1) / step - 1;
+        }
+
+        constexpr size_t size_of(size_t idx) noexcept
+        {
+            if (idx < 8)
+            { return 16 * (idx + 1); }
+            const size_t base = size_t{1} << (7 + (idx - 8) / 4);
+            return base + ((idx - 8) % 4 + 1) * (base / 4);
+        }
+
+        // over aligned requests take the power of two class, whose objects are aligned to their size.
+        constexpr size_t class_of(size_t bytes, size_t align) noexcept
+        { return align <= 16 ? class_of(bytes) : class_of(std::bit_ceil(std::max(bytes, align))); }
+
+        struct cache;
+
+        // slab header, objects follow it. slabs are aligned to their size, so an object find its slab with a mask.
+        struct slab : public concurrency::stack_hook
+        {
+            cache* m_owner;
+            slab* m_prev;       // partial list of the owner
+            slab* m_next;
+            slab* m_all;        // every slab of the resource
+            size_t m_class;
+            size_t m_size;
+            size_t m_used;      // objects out, remote frees not yet drained included
+            void* m_free;       // freed objects, linked through their first word
+            byte_t* m_bump;
+            byte_t* m_end;
+            bool m_partial;
+
+            static constexpr size_t header_size() noexcept { return (sizeof(slab) + max_align() - 1) / max_align() * max_align(); }
+
+            void init(cache* owner, size_t idx, size_t slab_size) noexcept
+            {
+                m_owner = owner;
+                m_prev = m_next = nullptr;
+                m_class = idx;
+                m_size = size_of(idx);
+                m_used = 0;
+                m_free = nullptr;
+                byte_t* base = reinterpret_cast<byte_t*>(this);
+                // power of two classes start at a multiple of their size (up to max_align).
+                const size_t align = std::min<size_t>(size_t{1} << std::countr_zero(m_size), max_align());
+                m_bump = base + (header_size() + align - 1) / align * align;
+                m_end = base + slab_size - (slab_size - static_cast<size_t>(m_bump - base)) % m_size;
+                m_partial = false;
+            }
+
+            void* take() noexcept
+            {
+                void* ret = m_free;
+                if (ret != nullptr)
+                { m_free = *static_cast<void**>(ret); }
+                else if (m_bump != m_end)
+                {
+                    ret = m_bump;
+                    m_bump += m_size;
+                }
+                else
+                { return nullptr; }
+                ++m_used;
+                return ret;
+            }
+
+            void give(void* ptr) noexcept
+            {
+                *static_cast<void**>(ptr) = m_free;
+                m_free = ptr;
+                --m_used;
+            }
+
+            bool has_room() const noexcept { return m_free != nullptr || m_bump != m_end; }
+        };
+
+        // per-thread state (thread_record_list record). only the owner touch it, except m_remote.
+        struct cache
+        {
+            slab* m_current[class_num()] { };
+            slab* m_partial[class_num()] { };
+            slab* m_empty = nullptr;    // linked through m_next
+            size_t m_empty_num = 0;
+            true_share<std::atomic<void*>> m_remote { }; // objects freed by other threads, mpsc
+
+            void link_partial(slab* arg) noexcept
+            {
+                slab*& head = m_partial[arg->m_class];
+                arg->m_prev = nullptr;
+                arg->m_next = head;
+                if (head != nullptr) { head->m_prev = arg; }
+                head = arg;
+                arg->m_partial = true;
+            }
+
+            void unlink_partial(slab* arg) noexcept
+            {
+                if (arg->m_prev != nullptr) { arg->m_prev->m_next = arg->m_next; }
+                else { m_partial[arg->m_class] = arg->m_next; }
+                if (arg->m_next != nullptr) { arg->m_next->m_prev = arg->m_prev; }
+                arg->m_prev = arg->m_next = nullptr;
+                arg->m_partial = false;
+            }
+        };
+    } // namespace slab_detail
+
+    // size-class slab allocator with per-thread caches.
+    // each thread own its slabs (SlabSize, aligned to SlabSize). allocate and a free from the owning thread
+    // only edit the slab free list, no atomic operation. a free from another thread push the object to the owner's
+    // remote list (one CAS), the owner drain the whole list with one exchange when its slab run dry.
+    // empty slabs are kept per thread and moved to the shared depot in bulk (one CAS per EmptyBatch slabs).
+    // requests over 4096 bytes or 64 alignment go to the upstream resource.
+    // slabs go back to the upstream only with the resource.
+    template <size_t SlabSize = 65536, size_t EmptyBatch = 4>
+        requires (std::has_single_bit(SlabSize) && (SlabSize >= 4 * slab_detail::max_size()) && (EmptyBatch > 0))
+    struct slab_resource final : public std::pmr::memory_resource
+    {
+        private:
+            using slab = slab_detail::slab;
+            using cache = slab_detail::cache;
+
+            std::pmr::memory_resource* m_upstream;
+            concurrency::intrusive_stack<slab> m_depot;
+            true_share<std::atomic<slab*>> m_all;
+            concurrency::thread_record_list<cache> m_caches;
+
+            static slab* slab_of(void* ptr) noexcept
+            { return reinterpret_cast<slab*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(static_cast<std::uintptr_t>(SlabSize) - 1)); }
+
+            slab* make_slab(cache& local, size_t idx)
+            {
+                slab* ret = local.m_empty;
+                if (ret != nullptr)
+                {
+                    local.m_empty = ret->m_next;
+                    --local.m_empty_num;
+                }
+                else if (ret = m_depot.pop(); ret == nullptr)
+                {
+                    ret = static_cast<slab*>(m_upstream->allocate(SlabSize, SlabSize));
+                    std::construct_at(ret);
+                    ret->m_all = m_all->load(std::memory_order::relaxed);
+                    while (!m_all->compare_exchange_weak(ret->m_all, ret, std::memory_order::release, std::memory_order::relaxed)) { }
+                }
+                ret->init(&local, idx, SlabSize);
+                return ret;
+            }
+
+            void retire(cache& local, slab* target) noexcept
+            {
+                target->m_owner = nullptr;
+                target->m_next = local.m_empty;
+                local.m_empty = target;
+                if (++local.m_empty_num < 2 * EmptyBatch)
+                { return; }
+                // keep EmptyBatch, move the rest to the depot with one push.
+                slab* first = local.m_empty;
+                slab* last = first;
+                for (size_t count = 1; count < EmptyBatch; ++count)
+                {
+                    last->m_stack_next.store(last->m_next, std::memory_order::relaxed);
+                    last = last->m_next;
+                }
+                local.m_empty = last->m_next;
+                local.m_empty_num -= EmptyBatch;
+                m_depot.push_chain(first, last);
+            }
+
+            void free_local(cache& local, slab* target, void* ptr) noexcept
+            {
+                target->give(ptr);
+                if (target == local.m_current[target->m_class])
+                { return; }
+                if (target->m_used == 0)
+                {
+                    if (target->m_partial) { local.unlink_partial(target); }
+                    retire(local, target);
+                }
+                else if (!target->m_partial)
+                { local.link_partial(target); }
+            }
+
+            void drain(cache& local) noexcept
+            {
+                void* at = local.m_remote->exchange(nullptr, std::memory_order::acquire);
+                while (at != nullptr)
+                {
+                    void* next = *static_cast<void**>(at);
+                    free_local(local, slab_of(at), at);
+                    at = next;
+                }
+            }
+
+            void* refill(cache& local, size_t idx)
+            {
+                if (local.m_remote->load(std::memory_order::relaxed) != nullptr)
+                {
+                    drain(local);
+                    if (slab* current = local.m_current[idx]; current != nullptr && current->has_room())
+                    { return current->take(); }
+                }
+                slab* next = local.m_partial[idx];
+                if (next != nullptr)
+                { local.unlink_partial(next); }
+                else
+                { next = make_slab(local, idx); }
+                // the exhausted slab get back on the partial list when one of its objects is freed.
+                local.m_current[idx] = next;
+                return next->take();
+            }
+
+            void* do_allocate(size_t bytes, size_t align) override
+            {
+                if (bytes > slab_detail::max_size() || align > slab_detail::max_align())
+                { return m_upstream->allocate(bytes, align); }
+                const size_t idx = slab_detail::class_of(bytes, align);
+                cache& local = m_caches.local();
+                if (slab* current = local.m_current[idx]; current != nullptr)
+                {
+                    if (void* ret = current->take(); ret != nullptr)
+                    { return ret; }
+                }
+                return refill(local, idx);
+            }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t align) override
+            {
+                if (bytes > slab_detail::max_size() || align > slab_detail::max_align())
+                {
+                    m_upstream->deallocate(ptr, bytes, align);
+                    return;
+                }
+                cache& local = m_caches.local();
+                slab* target = slab_of(ptr);
+                if (target->m_owner == &local)
+                {
+                    free_local(local, target, ptr);
+                    return;
+                }
+                std::atomic<void*>& remote = target->m_owner->m_remote.ref();
+                void* head = remote.load(std::memory_order::relaxed);
+                do
+                { *static_cast<void**>(ptr) = head; }
+                while (!remote.compare_exchange_weak(head, ptr, std::memory_order::release, std::memory_order::relaxed));
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            { return this == &arg; }
+
+        public:
+            slab_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+                : m_upstream(upstream), m_depot(), m_all(nullptr), m_caches()
+            { }
+
+            slab_resource(const slab_resource&) = delete;
+            slab_resource& operator=(const slab_resource&) = delete;
+
+            // every slab go back to the upstream. objects still out are not destroyed.
+            ~slab_resource() noexcept override
+            {
+                for (slab* at = m_all->load(std::memory_order::acquire); at != nullptr;)
+                {
+                    slab* next = at->m_all;
+                    m_upstream->deallocate(at, SlabSize, SlabSize);
+                    at = next;
+                }
+            }
+
+            static constexpr size_t slab_size() noexcept { return SlabSize; }
+            static constexpr size_t size_class(size_t bytes, size_t align = alignof(std::max_align_t)) noexcept
+            { return slab_detail::size_of(slab_detail::class_of(bytes, align)); }
+
+            std::pmr::memory_resource* upstream() const noexcept { return m_upstream; }
+
+            // take back objects other threads freed to this thread.
+            void collect() noexcept
+            { drain(m_caches.local()); }
+
+            // give this thread's cache back (call before thread exit on thread churn).
+            // its slabs stay with the cache and are taken over by the next thread that adopt it.
+            void detach() noexcept
+            {
+                collect();
+                m_caches.release();
+            }
+    };
+
+    template <typename T, size_t SlabSize = 65536, size_t EmptyBatch = 4>
+    using slab_allocator = resource_allocator<T, slab_resource<SlabSize, EmptyBatch>>;
+} // namespace sia
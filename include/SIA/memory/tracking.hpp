@@ -0,0 +1,344 @@
+#pragma once
+
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <source_location>
+#include <memory_resource>
+
+#include "SIA/internals/types.hpp"
+#include "SIA/utility/tools.hpp"
+#include "SIA/utility/compressed_pair.hpp"
+#include "SIA/utility/types/constant_string.hpp"
+#include "SIA/concurrency/internals/types.hpp"
+#include "SIA/concurrency/utility/mutex.hpp"
+#include "SIA/concurrency/utility/quota.hpp"
+#include "SIA/concurrency/utility/profiled.hpp"
+#include "SIA/concurrency/utility/thread_record.hpp"
+
+namespace sia
+{
+    namespace tracking_detail
+    {
+        // per-thread counters. only the owner thread write them, so a plain load / store is enough (no locked instruction).
+        struct counter
+        {
+            std::atomic<size_t> m_alloc_num { };
+            std::atomic<size_t> m_alloc_bytes { };
+            std::atomic<size_t> m_free_num { };
+            std::atomic<size_t> m_free_bytes { };
+
+            static void add(std::atomic<size_t>& target, size_t value) noexcept
+            { target.store(target.load(std::memory_order::relaxed) + value, std::memory_order::relaxed); }
+
+            static void reset(counter& target) noexcept
+            {
+                target.m_alloc_num.store(0, std::memory_order::relaxed);
+                target.m_alloc_bytes.store(0, std::memory_order::relaxed);
+                target.m_free_num.store(0, std::memory_order::relaxed);
+                target.m_free_bytes.store(0, std::memory_order::relaxed);
+            }
+        };
+
+        // birth time of sampled blocks, direct mapped. a sample that hit a used slot is dropped (counted).
+        struct birth
+        {
+            std::atomic<std::uintptr_t> m_addr { };
+            std::atomic<std::uint64_t> m_ns { };
+        };
+
+        constexpr std::uint64_t mix(std::uintptr_t addr) noexcept
+        { return (static_cast<std::uint64_t>(addr) >> 4) * 0x9E3779B97F4A7C15ULL; }
+
+        inline std::uint64_t now_ns() noexcept
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    } // namespace tracking_detail
+
+    // totals of one allocation site.
+    struct allocation_stat
+    {
+        size_t m_alloc_num;
+        size_t m_alloc_bytes;
+        size_t m_free_num;
+        size_t m_free_bytes;
+        size_t m_live_bytes;
+        size_t m_peak_bytes; // sampled estimate (exact when the sample rate is 1)
+    };
+
+    // statistics of one call site (a constant_string tag or a std::source_location). registered in a global list on construction.
+    // counts and bytes are exact, kept in per-thread records.
+    // peak and lifetime come from sampled blocks : one address in SampleRate (by address hash, so allocate and deallocate agree).
+    struct allocation_site
+    {
+        private:
+            using counter_type = tracking_detail::counter;
+            using birth_type = tracking_detail::birth;
+
+            static constexpr size_t birth_num() noexcept { return 4096; }
+
+            std::string_view m_name;
+            size_t m_line;
+            size_t m_sample_rate;
+            size_t m_sample_shift;
+            concurrency::thread_record_list<counter_type> m_counter;
+            true_share<counter_type> m_shared;  // frees of threads whose record could not be made, shared (locked instructions).
+            true_share<std::atomic<std::int64_t>> m_live;
+            std::atomic<std::int64_t> m_peak;
+            std::atomic<size_t> m_dropped;
+            profile_detail::histogram m_lifetime;
+            std::unique_ptr<birth_type[]> m_birth;
+            allocation_site* m_next;
+
+            bool is_sampled(std::uint64_t hash) const noexcept
+            { return m_sample_rate == 1 || (hash >> m_sample_shift) == 0; }
+
+        public:
+            static std::atomic<allocation_site*>& head() noexcept
+            {
+                static constinit std::atomic<allocation_site*> s_head {nullptr};
+                return s_head;
+            }
+
+            // sample_rate is rounded up to a power of two. line is 0 for named sites.
+            allocation_site(std::string_view name, size_t line = 0, size_t sample_rate = 1)
+                : m_name(name), m_line(line), m_sample_rate(std::bit_ceil(sample_rate == 0 ? size_t{1} : sample_rate)),
+                  m_sample_shift(64 - static_cast<size_t>(std::countr_zero(m_sample_rate))),
+                  m_counter(), m_shared(), m_live(0), m_peak(0), m_dropped(0), m_lifetime(), m_birth(new birth_type[birth_num()]),
+                  m_next(head().load(std::memory_order::relaxed))
+            { while (!head().compare_exchange_weak(m_next, this, std::memory_order::release, std::memory_order::relaxed)) { } }
+
+            allocation_site(const allocation_site&) = delete;
+            allocation_site& operator=(const allocation_site&) = delete;
+
+            // the site of a source location, made on first use and never freed.
+            static allocation_site& at(const std::source_location& loc, size_t sample_rate = 1)
+            {
+                static sia::mutex s_lock { };
+                quota guard {s_lock};
+                const size_t rate = std::bit_ceil(sample_rate == 0 ? size_t{1} : sample_rate);
+                for (allocation_site* iter = head().load(std::memory_order::acquire); iter != nullptr; iter = iter->m_next)
+                {
+                    if (iter->m_line == loc.line() && iter->m_sample_rate == rate && iter->m_name == loc.file_name())
+                    { return *iter; }
+                }
+                return *new allocation_site(loc.file_name(), loc.line(), rate);
+            }
+
+            constexpr std::string_view name() const noexcept { return m_name; }
+            constexpr size_t line() const noexcept { return m_line; }
+            constexpr size_t sample_rate() const noexcept { return m_sample_rate; }
+            const profile_detail::histogram& lifetime() const noexcept { return m_lifetime; }
+            size_t dropped() const noexcept { return m_dropped.load(std::memory_order::relaxed); }
+
+            void on_allocate(void* ptr, size_t bytes)
+            {
+                counter_type& local = m_counter.local();
+                counter_type::add(local.m_alloc_num, 1);
+                counter_type::add(local.m_alloc_bytes, bytes);
+                const std::uint64_t hash = tracking_detail::mix(reinterpret_cast<std::uintptr_t>(ptr));
+                if (!is_sampled(hash))
+                { return; }
+                const std::int64_t live = m_live->fetch_add(static_cast<std::int64_t>(bytes * m_sample_rate), std::memory_order::relaxed)
+                    + static_cast<std::int64_t>(bytes * m_sample_rate);
+                std::int64_t peak = m_peak.load(std::memory_order::relaxed);
+                while (peak < live && !m_peak.compare_exchange_weak(peak, live, std::memory_order::relaxed, std::memory_order::relaxed)) { }
+                birth_type& slot = m_birth[hash % birth_num()];
+                std::uintptr_t vacant { };
+                if (slot.m_addr.compare_exchange_strong(vacant, reinterpret_cast<std::uintptr_t>(ptr), std::memory_order::relaxed, std::memory_order::relaxed))
+                { slot.m_ns.store(tracking_detail::now_ns(), std::memory_order::relaxed); }
+                else
+                { m_dropped.fetch_add(1, std::memory_order::relaxed); }
+            }
+
+            // never throw : a thread without a record (allocation failure) count in the shared counter.
+            void on_deallocate(void* ptr, size_t bytes) noexcept
+            {
+                if (counter_type* local = m_counter.try_local(); local != nullptr)
+                {
+                    counter_type::add(local->m_free_num, 1);
+                    counter_type::add(local->m_free_bytes, bytes);
+                }
+                else
+                {
+                    m_shared->m_free_num.fetch_add(1, std::memory_order::relaxed);
+                    m_shared->m_free_bytes.fetch_add(bytes, std::memory_order::relaxed);
+                }
+                const std::uint64_t hash = tracking_detail::mix(reinterpret_cast<std::uintptr_t>(ptr));
+                if (!is_sampled(hash))
+                { return; }
+                m_live->fetch_sub(static_cast<std::int64_t>(bytes * m_sample_rate), std::memory_order::relaxed);
+                birth_type& slot = m_birth[hash % birth_num()];
+                if (slot.m_addr.load(std::memory_order::relaxed) == reinterpret_cast<std::uintptr_t>(ptr))
+                {
+                    const std::uint64_t born = slot.m_ns.load(std::memory_order::relaxed);
+                    slot.m_addr.store(0, std::memory_order::relaxed);
+                    m_lifetime.record(static_cast<size_t>(tracking_detail::now_ns() - born));
+                }
+            }
+
+            allocation_stat stat()
+            {
+                allocation_stat ret { };
+                const auto sum = [&ret] (counter_type& elem) noexcept
+                {
+                    ret.m_alloc_num += elem.m_alloc_num.load(std::memory_order::relaxed);
+                    ret.m_alloc_bytes += elem.m_alloc_bytes.load(std::memory_order::relaxed);
+                    ret.m_free_num += elem.m_free_num.load(std::memory_order::relaxed);
+                    ret.m_free_bytes += elem.m_free_bytes.load(std::memory_order::relaxed);
+                };
+                m_counter.for_each(sum);
+                sum(m_shared.ref());
+                ret.m_live_bytes = ret.m_alloc_bytes >= ret.m_free_bytes ? ret.m_alloc_bytes - ret.m_free_bytes : 0;
+                ret.m_peak_bytes = static_cast<size_t>(std::max<std::int64_t>(m_peak.load(std::memory_order::relaxed), 0));
+                return ret;
+            }
+
+            // counters written concurrently by their owner may lose the reset.
+            void reset() noexcept
+            {
+                m_counter.for_each(&counter_type::reset);
+                counter_type::reset(m_shared.ref());
+                m_peak.store(m_live->load(std::memory_order::relaxed), std::memory_order::relaxed);
+                m_dropped.store(0, std::memory_order::relaxed);
+                m_lifetime.reset();
+            }
+
+            void dump(std::ostream& os)
+            {
+                const allocation_stat st = stat();
+                os << "[" << m_name;
+                if (m_line != 0) { os << ":" << m_line; }
+                os << "] sampled 1 / " << m_sample_rate << '\n';
+                os << "  alloc " << st.m_alloc_num << " (" << st.m_alloc_bytes << " bytes), free " << st.m_free_num << " (" << st.m_free_bytes
+                    << " bytes), live " << st.m_live_bytes << " bytes, peak " << st.m_peak_bytes << " bytes\n";
+                os << "  lifetime : ";
+                m_lifetime.dump(os);
+            }
+
+            allocation_site* next() const noexcept { return m_next; }
+    };
+
+    template <constant_string Name, size_t SampleRate = 1>
+    inline allocation_site allocation_site_v {profile_detail::name_of<Name>(), 0, SampleRate};
+
+    template <typename Func>
+    void for_each_allocation_site(Func&& func)
+    {
+        for (allocation_site* at = allocation_site::head().load(std::memory_order::acquire); at != nullptr; at = at->next())
+        { func(*at); }
+    }
+
+    inline void dump_allocation_site(std::ostream& os)
+    { for_each_allocation_site([&os] (allocation_site& elem) { elem.dump(os); }); }
+
+    inline void reset_allocation_site() noexcept
+    { for_each_allocation_site([] (allocation_site& elem) noexcept { elem.reset(); }); }
+
+    // allocator adaptor recording every allocate / deallocate of the wrapped allocator into an allocation_site.
+    // without a site, the site is the source location where the allocator is constructed.
+    template <typename T, typename Allocator = std::allocator<T>>
+    struct tracking_allocator
+    {
+            template <typename Ty, typename Al>
+            friend struct tracking_allocator;
+        private:
+            using allocator_traits_t = std::allocator_traits<Allocator>;
+
+            compressed_pair<Allocator, allocation_site*> m_compair;
+
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = allocator_traits_t::propagate_on_container_copy_assignment;
+            using propagate_on_container_move_assignment = allocator_traits_t::propagate_on_container_move_assignment;
+            using propagate_on_container_swap = allocator_traits_t::propagate_on_container_swap;
+            using is_always_equal = std::false_type;
+
+            template <typename Ty>
+            struct rebind { using other = tracking_allocator<Ty, typename allocator_traits_t::template rebind_alloc<Ty>>; };
+
+            tracking_allocator(std::source_location loc = std::source_location::current()) requires (std::is_default_constructible_v<Allocator>)
+                : m_compair(splits::one_v, Allocator{ }, &allocation_site::at(loc))
+            { }
+
+            tracking_allocator(const Allocator& alloc, std::source_location loc = std::source_location::current())
+                : m_compair(splits::one_v, alloc, &allocation_site::at(loc))
+            { }
+
+            constexpr tracking_allocator(allocation_site& site, const Allocator& alloc = Allocator{ })
+                : m_compair(splits::one_v, alloc, &site)
+            { }
+
+            template <typename Ty, typename Al>
+            constexpr tracking_allocator(const tracking_allocator<Ty, Al>& arg)
+                : m_compair(splits::one_v, Allocator(arg.m_compair.first()), arg.m_compair.second())
+            { }
+
+            constexpr Allocator& inner() noexcept { return m_compair.first(); }
+            constexpr const Allocator& inner() const noexcept { return m_compair.first(); }
+            constexpr allocation_site& site() const noexcept { return *m_compair.second(); }
+
+            [[nodiscard]] T* allocate(size_t num)
+            {
+                T* ret = allocator_traits_t::allocate(inner(), num);
+                site().on_allocate(ret, num * sizeof(T));
+                return ret;
+            }
+
+            void deallocate(T* ptr, size_t num) noexcept
+            {
+                site().on_deallocate(ptr, num * sizeof(T));
+                allocator_traits_t::deallocate(inner(), ptr, num);
+            }
+
+            template <typename Ty, typename Al>
+            friend bool operator==(const tracking_allocator& lhs, const tracking_allocator<Ty, Al>& rhs) noexcept
+            { return lhs.m_compair.second() == rhs.m_compair.second() && lhs.inner() == rhs.inner(); }
+    };
+
+    // memory resource adaptor, same recording over an upstream std::pmr::memory_resource.
+    struct tracking_resource final : public std::pmr::memory_resource
+    {
+        private:
+            std::pmr::memory_resource* m_upstream;
+            allocation_site* m_site;
+
+            void* do_allocate(size_t bytes, size_t align) override
+            {
+                void* ret = m_upstream->allocate(bytes, align);
+                m_site->on_allocate(ret, bytes);
+                return ret;
+            }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t align) noexcept override
+            {
+                m_site->on_deallocate(ptr, bytes);
+                m_upstream->deallocate(ptr, bytes, align);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& arg) const noexcept override
+            { return this == &arg; }
+
+        public:
+            tracking_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(), std::source_location loc = std::source_location::current())
+                : m_upstream(upstream), m_site(&allocation_site::at(loc))
+            { }
+
+            tracking_resource(allocation_site& site, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+                : m_upstream(upstream), m_site(&site)
+            { }
+
+            tracking_resource(const tracking_resource&) = delete;
+            tracking_resource& operator=(const tracking_resource&) = delete;
+
+            std::pmr::memory_resource* upstream() const noexcept { return m_upstream; }
+            allocation_site& site() const noexcept { return *m_site; }
+    };
+} // namespace sia